@@ -37,6 +37,23 @@
  */
 #define AST_ROOT_STR	"[PROGRAM]"
 
+/**
+ * @def AST_VERSION
+ * @brief Version du format d'impression d'un AST (bytecode).
+ * 
+ * @note Les fichiers sans version (version 1) indiquent SYM[-1] sur chaque
+ * instruction simple : depuis la version 2, ce champ est le décalage de la
+ * case visée.
+ */
+#define AST_VERSION 2
+
+/**
+ * @def AST_VERSION_FORMAT
+ * @brief Format d'impression de la version d'un AST, avant sa racine.
+ * 
+ */
+#define AST_VERSION_FORMAT	"VERSION[%d]"
+
 /**
  * @def AST_TAB_STR
  * @brief Caractère de tabulation dans l'impression d'un AST.
@@ -119,14 +136,20 @@ typedef enum Astdata_type {
  * caractère, et le numéro lexicographique lorsqu'il s'agira d'une chaîne de
  * caractère ou d'un flottant.
  * @note Le type du noeud est défini comme un entier pour plus de généralité.
+ * @note Dans l'AST Brainfuck, 'id_lex' est le nombre de répétitions d'une
+ * instruction (le facteur d'un A_MUL, le pas d'un A_SCAN) et 'id_symb' le
+ * décalage de sa case par rapport au pointeur. Une boucle (A_LOOP) y range,
+ * après l'analyse des bornes (voir bounds.h), ses décalages extrêmes :
+ * minimal dans 'id_lex', maximal dans 'id_symb', ou -1 dans les deux si elle
+ * n'est pas dans les bornes (voir BOUNDS_IS_KNOWN).
  */
 typedef struct Astnode {
    	int type;    ///< Type du noeud.
 	union {
 		int constant;    ///< Données constantes.
 		struct {
-			int id_lex;              		    ///< Numéro lexicographique.
-			int id_symb;             		    ///< Numéro de symbole.
+			int id_lex;              		    ///< Numéro lexicographique (voir les notes).
+			int id_symb;             		    ///< Numéro de symbole (voir les notes).
 			struct Astnode *son;     		    ///< Noeud fils.
 			struct Astnode *little_brother;     ///< Noeud petit-frère.
 		};               ///< Données de type arbre.
@@ -0,0 +1,190 @@
+/**
+ * @file block.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la représentation en blocs de base d'un programme
+ * Brainfuck : chaque suite d'instructions sans boucle devient un ensemble
+ * d'affectations symboliques de cases (repérées par leur décalage) et
+ * d'entrées/sorties, sur lequel opèrent la propagation de constantes et la
+ * suppression des écritures mortes.
+ * @date 2024-05-22
+ * 
+ * 
+ */
+#ifndef _BLOCK_H_
+#define _BLOCK_H_
+
+#include <stdint.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def BLOCK_INITIAL_CAPACITY
+ * @brief Capacité initiale (en nombre d'opérations) d'un bloc de base.
+ * 
+ */
+#define BLOCK_INITIAL_CAPACITY 16
+
+/**
+ * @def BLOCK_OPT_LEVEL
+ * @brief Niveau d'optimisation (voir FLAG_OPT_LEVEL) à partir duquel les
+ * blocs de base sont optimisés.
+ * 
+ */
+#define BLOCK_OPT_LEVEL 1
+
+/**
+ * @def BLOCK_VECTOR_MIN
+ * @brief Nombre minimal de cases consécutives d'une suite d'ajouts (ou
+ * d'affectations) appliquée d'un seul coup, comme un vecteur de constantes.
+ * 
+ */
+#define BLOCK_VECTOR_MIN 8
+
+/* -------------------------------------------------------------------------- */
+/*                                 CONSTANTES                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @enum BLOCK_KINDS
+ * @brief Énumération des sortes de noeuds d'un programme en blocs de base.
+ * 
+ */
+enum BLOCK_KINDS {
+	B_BASIC,	///< Bloc de base : opérations, puis déplacement de 'shift'.
+	B_LOOP,		///< Boucle ("[...]") de corps 'body'.
+	B_SCAN		///< Recherche d'une case nulle par pas de 'shift'.
+};
+
+/**
+ * @enum BLOCK_OPS
+ * @brief Énumération des opérations d'un bloc de base.
+ * 
+ * @note Les décalages sont relatifs à la position du pointeur à l'entrée du
+ * bloc : un bloc ne déplace le pointeur qu'à sa sortie.
+ */
+enum BLOCK_OPS {
+	B_ADD,	///< Ajout de 'arg' à la case 'offset'.
+	B_SET,	///< Affectation de 'arg' à la case 'offset'.
+	B_MUL,	///< Ajout de la case 'source' multipliée par 'arg' à la case
+			///< 'offset' (si la case 'source' est non nulle).
+	B_PUT,	///< Affichage ('arg' fois) de la case 'offset'.
+	B_GET	///< Récupération ('arg' fois) d'une entrée dans la case 'offset'.
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Blockop
+ * @struct Blockop
+ * @brief Structure représentant une opération d'un bloc de base.
+ * 
+ * @note Les constantes ('arg' de B_ADD, B_SET et B_MUL) sont rangées par leur
+ * représentant signé modulo 2^n (n : largeur des cases).
+ */
+typedef struct Blockop {
+	int op;		///< Code d'opération (BLOCK_OPS).
+	int offset;	///< Décalage de la case écrite ou lue.
+	int arg;	///< Argument de l'opération.
+	int source;	///< Décalage de la case multipliée (B_MUL).
+} Blockop;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Block
+ * @struct Block
+ * @brief Structure représentant un noeud d'un programme en blocs de base (et,
+ * par ses champs 'next', la suite des noeuds qui le suivent).
+ * 
+ * @note 'node' désigne la boucle de l'arbre dont est issu un B_LOOP : ses
+ * marques de bornes (voir bounds.h) restent valables, les optimisations ne
+ * faisant que retirer des accès.
+ */
+typedef struct Block {
+	int kind;				///< Sorte du noeud (BLOCK_KINDS).
+	Blockop *ops;			///< Opérations (B_BASIC).
+	int length;				///< Nombre d'opérations (B_BASIC).
+	int capacity;			///< Nombre d'opérations allouées (B_BASIC).
+	int shift;				///< Déplacement final (B_BASIC) ou pas (B_SCAN).
+	struct Block *body;		///< Corps de la boucle (B_LOOP).
+	Asttree node;			///< Boucle d'origine (B_LOOP).
+	struct Block *next;		///< Noeud suivant.
+} Block;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Blockstats
+ * @struct Blockstats
+ * @brief Structure représentant le bilan de la construction et de
+ * l'optimisation d'un programme en blocs de base.
+ * 
+ */
+typedef struct Blockstats {
+	int blocks;		///< Nombre de blocs de base.
+	int ops;		///< Nombre d'opérations.
+	int constants;	///< Opérations réécrites ou supprimées (valeurs connues).
+	int merged;		///< Ajouts fusionnés avec un ajout précédent.
+	int stores;		///< Écritures mortes supprimées.
+	int loops;		///< Boucles (et recherches) mortes supprimées.
+	int vectors;	///< Suites vectorielles (voir block_run).
+	bool optimized;	///< Vaut true si les blocs ont été optimisés.
+} Blockstats;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Construit le programme en blocs de base d'un arbre, et l'optimise si
+ * le niveau d'optimisation est au moins BLOCK_OPT_LEVEL.
+ * 
+ * @param tree L'arbre du programme (ou de son reste).
+ * @param blank Vaut true si toute la bande est nulle au début de l'arbre.
+ * @param statsp Le pointeur vers le bilan à remplir, ou NULL.
+ * @return Block* Le premier noeud du programme (NULL s'il est vide).
+ */
+extern Block *block_program(Asttree tree, bool blank, Blockstats *statsp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la longueur de la suite vectorielle qui commence à une
+ * opération d'un bloc de base, ou 0.
+ * 
+ * @param node Le bloc de base.
+ * @param i L'indice de la première opération de la suite.
+ * @return int Le nombre d'opérations de la suite (au moins BLOCK_VECTOR_MIN),
+ * ou 0 s'il n'y en a pas.
+ */
+extern int block_run(Block *node, int i);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un programme en blocs de base.
+ * 
+ * @param progp Le pointeur vers le premier noeud du programme.
+ */
+extern void block_free(Block **progp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le bilan d'un programme en blocs de base sur la sortie
+ * donnée.
+ * 
+ * @param stats Le bilan.
+ * @param out La sortie sur laquelle imprimer le bilan.
+ */
+extern void block_print(Blockstats stats, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file bounds.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'analyse statique des positions atteintes par
+ * le pointeur de données : les boucles dont les accès restent dans un
+ * intervalle connu (relatif à leur entrée) sont marquées "dans les bornes", et
+ * la taille de bande nécessaire au programme est calculée lorsqu'elle est
+ * bornée.
+ * @date 2024-05-20
+ * 
+ * 
+ */
+#ifndef _BOUNDS_H_
+#define _BOUNDS_H_
+
+#include <limits.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def BOUNDS_IS_KNOWN
+ * @brief Fonction macro indiquant si les décalages extrêmes (low, high) d'une
+ * boucle sont connus.
+ * 
+ * @note Une boucle lit toujours sa case de test : un intervalle connu contient
+ * 0, si bien que la valeur initiale des champs d'un A_LOOP (-1, -1) signifie
+ * "non bornée".
+ */
+#define BOUNDS_IS_KNOWN(low, high) ((low) <= 0 && (high) >= 0)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Bounds
+ * @struct Bounds
+ * @brief Structure représentant le résultat de l'analyse des bornes d'un
+ * programme.
+ * 
+ * @note Les positions sont absolues : la première case de la bande est en 0.
+ */
+typedef struct Bounds {
+	bool bounded;	///< Vaut true si les positions atteintes sont bornées.
+	long low;		///< Position minimale atteinte (si bornée).
+	long high;		///< Position maximale atteinte (si bornée).
+	int loops;		///< Nombre de boucles analysées.
+	int inbounds;	///< Nombre de boucles dans les bornes.
+} Bounds;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Analyse les positions atteintes par un programme et marque ses
+ * boucles.
+ * 
+ * @param tree L'arbre (optimisé) du programme.
+ * @param start La position initiale du pointeur de données.
+ * @return Bounds Le résultat de l'analyse.
+ */
+extern Bounds bounds(Asttree tree, long start);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nombre de cases de bande nécessaires au programme
+ * analysé.
+ * 
+ * @param b Le résultat de l'analyse.
+ * @param minimum Le nombre minimal de cases (cases déjà initialisées).
+ * @param fallback Le nombre de cases si les positions ne sont pas bornées.
+ * @return long Le nombre de cases.
+ */
+extern long bounds_tape_size(Bounds b, long minimum, long fallback);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le résultat de l'analyse des bornes sur la sortie donnée.
+ * 
+ * @param b Le résultat de l'analyse.
+ * @param out La sortie sur laquelle imprimer le résultat.
+ */
+extern void bounds_print(Bounds b, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
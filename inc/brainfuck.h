@@ -27,16 +27,53 @@
 
 /**
  * @def HELP_NOTICE_FORMAT
- * @brief Notice d'utilisation du programme.
+ * @brief Notice d'utilisation du programme : usage et drapeaux.
  * 
+ * @note La notice est découpée en plusieurs chaînes (voir HELP_NOTICE_OPTIONS)
+ * pour que chacune reste sous les 4095 caractères garantis par C99.
  */
 #define HELP_NOTICE_FORMAT \
 		"\n" \
 	"- Interpréteur du langage Brainfuck" \
 	"\n" \
-	"- Usage: %s [<option> [<sous-option>]] [<entree>] [<sortie>]\n" \
+	"- Usage: %s [<drapeaux>] [<option> [<sous-option>]] [<entree>] [<sortie>]\n" \
 	"\n" \
+	"  -    [<drapeaux>]                 :    -t    exécute en parcourant l'arbre (AST)\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -j    compile à la volée (JIT x86-64)\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -T[n] compile les boucles chaudes\n" \
+	"                                               (n retours arrière, défaut 1000)\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -s    affiche les statistiques (stderr)\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -w<n> cases de n bits (8, 16, 32)\n" \
+	"                                               (défaut 32)\n" \
+	"                                         + optionnel pour les options {-i, -ib, -c, -cb}\n" \
+	"                                         -p    bande creuse (pages à la demande)\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -R<f> enregistre le profil dans f\n" \
+	"                                         -F<f> superinstructions du profil f\n" \
+	"                                         + optionnel pour les options {-i, -ib}\n" \
+	"                                         -E[n] évalue le préfixe sans lecture\n" \
+	"                                               (n pas au plus, défaut 10^7)\n" \
+	"                                         + optionnel pour les options {-i, -ib, -c, -cb}\n" \
+	"                                         -U<n> déroule les boucles de tours connus\n" \
+	"                                               (facteur n, défaut 8, 1 : aucun)\n" \
+	"                                         -O<n> niveau d'optimisation (0 à 3)\n" \
+	"                                               (défaut 3)\n" \
+	"                                         + optionnel pour les options {-i, -ib, -c, -cb}\n" \
+	"\n"
+
+/**
+ * @def HELP_NOTICE_OPTIONS
+ * @brief Notice d'utilisation du programme : options, sous-options, entrée
+ * et sortie (suite de HELP_NOTICE_FORMAT).
+ * 
+ */
+#define HELP_NOTICE_OPTIONS \
 	"  -    [<option>]                   :    -h    affiche la notice d'utilisation\n" \
+	"                                         -v    affiche la configuration de la VM\n" \
 	"                                         -c    compile le programme en entrée\n" \
 	"                                         -cb   compile le bytecode en entrée\n" \
 	"                                         -i    interprète le programme en entrée\n" \
@@ -45,6 +82,10 @@
 	"\n" \
 	"  +    -    [<sous-option>]         :    python    compile en Python\n" \
 	"                                         c         compile en C\n" \
+	"                                         asm       compile en assembleur x86-64\n" \
+	"                                         llvm      compile en LLVM IR\n" \
+	"                                         elf       compile en exécutable ELF x86-64\n" \
+	"                                         min       compile en Brainfuck minimal\n" \
 	"                                         + optionnel pour l'option {-c}\n" \
 	"                                         + nécessaire pour l'option {-cb}\n" \
 	"                                         bytecode  compile en C\n" \
@@ -66,6 +107,103 @@
 	"  -    default                      :    affiche la notice d'utilisation\n" \
 	"\n"
 
+/**
+ * @def FLAG_TREE_WALKER
+ * @brief Drapeau demandant l'exécution par parcours de l'arbre (AST) plutôt
+ * que par le programme linéaire.
+ * 
+ */
+#define FLAG_TREE_WALKER "-t"
+
+/**
+ * @def FLAG_JIT
+ * @brief Drapeau demandant l'exécution par compilation à la volée (JIT) en
+ * code machine.
+ * 
+ */
+#define FLAG_JIT "-j"
+
+/**
+ * @def FLAG_TIERED
+ * @brief Drapeau demandant l'exécution par niveaux : les boucles sont
+ * interprétées, puis compilées à la volée au-delà d'un seuil de retours
+ * arrière, éventuellement accolé au drapeau ("-T500").
+ * 
+ */
+#define FLAG_TIERED "-T"
+
+/**
+ * @def FLAG_STATS
+ * @brief Drapeau demandant l'affichage des statistiques d'exécution sur la
+ * sortie d'erreur.
+ * 
+ */
+#define FLAG_STATS "-s"
+
+/**
+ * @def FLAG_CELL_BITS
+ * @brief Drapeau choisissant la largeur (en bits) des cases de la bande de
+ * données, accolé à la largeur ("-w8", "-w16" ou "-w32").
+ * 
+ */
+#define FLAG_CELL_BITS "-w"
+
+/**
+ * @def FLAG_SPARSE
+ * @brief Drapeau demandant une bande de données creuse (pages allouées au
+ * premier accès, positions négatives permises).
+ * 
+ */
+#define FLAG_SPARSE "-p"
+
+/**
+ * @def FLAG_PROFILE_RECORD
+ * @brief Drapeau demandant l'enregistrement (cumulé) des fréquences des suites
+ * d'instructions exécutées, accolé au chemin du profil ("-Rprofil.txt").
+ * 
+ */
+#define FLAG_PROFILE_RECORD "-R"
+
+/**
+ * @def FLAG_PROFILE_FUSE
+ * @brief Drapeau demandant la fusion des suites d'instructions les plus
+ * fréquentes d'un profil en superinstructions, accolé au chemin du profil
+ * ("-Fprofil.txt").
+ * 
+ */
+#define FLAG_PROFILE_FUSE "-F"
+
+/**
+ * @def FLAG_PEVAL
+ * @brief Drapeau demandant l'évaluation partielle du programme (jusqu'à sa
+ * première lecture), éventuellement accolé au nombre maximal de pas
+ * ("-E" ou "-E1000000").
+ * 
+ */
+#define FLAG_PEVAL "-E"
+
+/**
+ * @def FLAG_UNROLL
+ * @brief Drapeau choisissant le facteur de déroulage des boucles dont le
+ * nombre de tours est connu, accolé au facteur ("-U4", "-U1" : aucun
+ * déroulage).
+ */
+#define FLAG_UNROLL "-U"
+
+/**
+ * @def FLAG_OPT_LEVEL
+ * @brief Drapeau choisissant le niveau d'optimisation de l'arbre, accolé au
+ * niveau ("-O0" à "-O3").
+ */
+#define FLAG_OPT_LEVEL "-O"
+
+/**
+ * @def CELL_DEFAULT_BITS
+ * @brief Largeur par défaut (en bits) des cases de la bande de données.
+ * 
+ */
+#define CELL_DEFAULT_BITS 32
+
 /**
  * @def EMPTY_BUFFER
  * @brief Fonction macro permettant de vider le buffer.
@@ -86,7 +224,8 @@
  */
 #define AST_TYPES_STRINGS { \
 	"PLUS", "MOINS", "DROITE", "GAUCHE", \
-	"ÉCRITURE", "LECTURE", "BOUCLE" \
+	"ÉCRITURE", "LECTURE", "BOUCLE", \
+	"RAZ", "RECHERCHE", "MULTIPLICATION" \
 }
 
 
@@ -106,6 +245,7 @@ enum EXEC_MODES {
 	MODE_COMPILE  ,  ///< Compilation d'un programme Brainfuck.
 	MODE_DECOMPILE,  ///< Décompilation d'un bytecode Brainfuck.
 	MODE_VM,		 ///< Exécution d'un programme Brainfuck en Bytecode.
+	MODE_INFO,		 ///< Affichage de la configuration de la machine virtuelle.
 };
 
 /* -------------------------------------------------------------------------- */
@@ -115,6 +255,9 @@ enum EXEC_MODES {
  * @brief Énumération des types d'arbres associés aux instructions du langage
  * Brainfuck.
  * 
+ * @note Le champ 'id_lex' d'un noeud indique le nombre d'opérations simples
+ * successives. Pour A_INC, A_DEC, A_PUT, A_GET et A_CLEAR, le champ 'id_symb'
+ * indique le décalage de la case visée par rapport au pointeur de données.
  */
 enum AST_TYPES {
 	A_INC  ,  ///< Incrémentation de la case de données pointée.
@@ -123,9 +266,39 @@ enum AST_TYPES {
 	A_LEFT ,  ///< Déplacement du pointeur de données à gauche.
 	A_PUT  ,  ///< Affichage de la valeur de la donnée pointée.
 	A_GET  ,  ///< Récupération d'une entrée.
-	A_LOOP    ///< Boucle.
+	A_LOOP ,  ///< Boucle.
+	A_CLEAR,  ///< Remise à zéro de la case de données pointée ("[-]").
+	A_SCAN ,  ///< Recherche d'une case nulle par pas de 'id_lex' ("[>]").
+	A_MUL     ///< Ajout de la case pointée multipliée par 'id_lex' à la case
+			  ///< située à 'id_symb' cases ("[->++<]").
 };
 
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Options
+ * @struct Options
+ * @brief Structure regroupant les drapeaux passés au programme.
+ * 
+ * @note Les drapeaux peuvent être placés n'importe où dans les arguments
+ * d'appel ; ils en sont retirés avant l'analyse de l'option principale.
+ */
+typedef struct Options {
+	bool tree_walker;	///< Exécution par parcours de l'arbre (AST).
+	bool jit;			///< Exécution par compilation à la volée (JIT).
+	long tier_threshold;///< Seuil de l'exécution par niveaux (0 : désactivée).
+	bool stats;			///< Affichage des statistiques d'exécution.
+	int cell_bits;		///< Largeur des cases (8, 16 ou 32 bits).
+	bool sparse;		///< Bande de données creuse.
+	char *profile_out;	///< Profil à enregistrer (NULL : aucun).
+	char *profile_in;	///< Profil des superinstructions (NULL : aucun).
+	long peval_budget;	///< Pas de l'évaluation partielle (0 : désactivée).
+	int unroll;			///< Facteur de déroulage des boucles (1 : aucun).
+	int opt_level;		///< Niveau d'optimisation (0 à 3).
+} Options;
+
 /* -------------------------------------------------------------------------- */
 
 #endif
\ No newline at end of file
@@ -11,6 +11,12 @@
 
 #include "brainfuck.h"
 #include "parser.h"
+#include "optimizer.h"
+#include "peval.h"
+#include "bounds.h"
+#include "block.h"
+#include "elf.h"
+#include "decompiler.h"
 #include "parser_ast.tab.h"
 #include "parser_code.tab.h"
 
@@ -58,20 +64,126 @@
  */
 #define CMODE_CC_ARG "c"
 
+/**
+ * @def CMODE_AC_ARG
+ * @brief Chaîne de caractères représentant l'argument d'option de compilation
+ * vers de l'assembleur x86-64.
+ * 
+ */
+#define CMODE_AC_ARG "asm"
+
+/**
+ * @def CMODE_LC_ARG
+ * @brief Chaîne de caractères représentant l'argument d'option de compilation
+ * vers de la représentation intermédiaire LLVM (textuelle).
+ * 
+ */
+#define CMODE_LC_ARG "llvm"
+
+/**
+ * @def CMODE_EC_ARG
+ * @brief Chaîne de caractères représentant l'argument d'option de compilation
+ * vers un exécutable ELF x86-64.
+ * 
+ */
+#define CMODE_EC_ARG "elf"
+
+/**
+ * @def CMODE_MC_ARG
+ * @brief Chaîne de caractères représentant l'argument d'option de compilation
+ * vers un programme Brainfuck minimal.
+ * 
+ */
+#define CMODE_MC_ARG "min"
+
+/**
+ * @def STACK_LENGTH_DEFAULT
+ * @brief Nombre de cases de la bande des programmes générés, lorsque les
+ * positions atteintes par le programme ne sont pas bornées (voir bounds.h).
+ * 
+ */
+#define STACK_LENGTH_DEFAULT 32000
+
 /* --------------------------------- Python --------------------------------- */
 
 /**
- * @def PYTHON_HEADER
- * @brief Chaîne de caractères représentant l'entête d'un programme Brainfuck
- * convertis en programme python.
+ * @def PYTHON_NESTING_LIMIT
+ * @brief Nombre maximal de boucles imbriquées dans une même fonction d'un
+ * programme Python généré.
  * 
+ * @note CPython refuse plus de 20 blocs imbriqués statiquement dans une
+ * fonction : une boucle plus profonde devient une fonction auxiliaire.
  */
-#define PYTHON_HEADER \
+#define PYTHON_NESTING_LIMIT 16
+
+/**
+ * @def PYTHON_HELPERS_CAPACITY
+ * @brief Capacité initiale de la file des fonctions auxiliaires d'un
+ * programme Python généré.
+ * 
+ */
+#define PYTHON_HELPERS_CAPACITY 16
+
+/**
+ * @def PYTHON_HEADER_FORMAT
+ * @brief Format représentant l'entête d'un programme Brainfuck convertis en
+ * programme python (la taille de la bande dépend des positions atteintes, le
+ * masque des cases de leur largeur, puis la construction de la bande).
+ * 
+ * @note La sortie est accumulée dans un bytearray écrit par
+ * sys.stdout.buffer.write lorsqu'il est plein, avant chaque lecture et à la
+ * fin du programme. La bande est précédée d'une marge nulle (voir
+ * ASM_TAPE_MARGIN).
+ */
+#define PYTHON_HEADER_FORMAT \
 	"#!/usr/bin/env python3\n\n" \
-	"STACK_LENGTH = 32000\n\n" \
+	"import sys\n\n" \
+	"STACK_LENGTH = %ld\n" \
+	"STACK_MARGIN = 4096\n" \
+	"OUTPUT_LENGTH = 65536\n" \
+	"MASK = 0x%X\n\n" \
+	"write = sys.stdout.buffer.write\n" \
+	"read = sys.stdin.buffer.read\n\n" \
+	"def flush(out):\n" \
+	"\twrite(out)\n" \
+	"\tout.clear()\n\n" \
+	"def get(out):\n" \
+	"\tflush(out)\n" \
+	"\tsys.stdout.buffer.flush()\n" \
+	"\tbyte = read(1)\n" \
+	"\treturn byte[0] if byte else MASK\n\n" \
 	"def main():\n" \
-	"\tstack = [0] * STACK_LENGTH\n" \
-	"\ti = 0\n"
+	"\tstack = %s\n" \
+	"\tout = bytearray()\n" \
+	"\ti = STACK_MARGIN\n"
+
+/**
+ * @def PYTHON_BYTES_TAPE
+ * @brief Chaîne de caractères représentant la construction de la bande d'un
+ * programme python aux cases de 8 bits.
+ * 
+ */
+#define PYTHON_BYTES_TAPE \
+	"bytearray(STACK_MARGIN + STACK_LENGTH)"
+
+/**
+ * @def PYTHON_LIST_TAPE
+ * @brief Chaîne de caractères représentant la construction de la bande d'un
+ * programme python aux cases de 16 ou 32 bits.
+ * 
+ */
+#define PYTHON_LIST_TAPE \
+	"[0] * (STACK_MARGIN + STACK_LENGTH)"
+
+/**
+ * @def PYTHON_MAIN_END
+ * @brief Chaîne de caractères représentant la fin de la fonction principale
+ * d'un programme Brainfuck convertis en programme python (vidage du tampon
+ * de sortie).
+ * 
+ */
+#define PYTHON_MAIN_END \
+	"flush(out)\n"
 
 /**
  * @def PYTHON_FOOTER
@@ -90,85 +202,228 @@
  * 
  */
 #define PYTHON_LOOP \
-	"while (stack[i]):\n"
+	"while stack[i]:\n"
+
+/**
+ * @def PYTHON_HELPER_FORMAT
+ * @brief Format représentant l'entête d'une fonction auxiliaire (boucle trop
+ * profonde) d'un programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_HELPER_FORMAT \
+	"\ndef loop_%d(stack, i, out):\n"
+
+/**
+ * @def PYTHON_HELPER_END
+ * @brief Chaîne de caractères représentant la fin d'une fonction auxiliaire
+ * d'un programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_HELPER_END \
+	"return i\n"
 
 /**
- * @def PYTHON_INC
- * @brief Chaîne de caractères représentant l'instruction d'incrémentation d'un
+ * @def PYTHON_CALL_FORMAT
+ * @brief Format représentant l'appel d'une fonction auxiliaire d'un
  * programme Brainfuck convertis en programme python.
  * 
  */
-#define PYTHON_INC \
-	"stack[i] += 1\n"
+#define PYTHON_CALL_FORMAT \
+	"i = loop_%d(stack, i, out)\n"
 
 /**
- * @def PYTHON_DEC
- * @brief Chaîne de caractères représentant l'instruction de décrémentation d'un
+ * @def PYTHON_ADD_FORMAT
+ * @brief Format représentant l'ajout d'une constante à une case d'un
  * programme Brainfuck convertis en programme python.
  * 
  */
-#define PYTHON_DEC \
-	"stack[i] -= 1\n"
+#define PYTHON_ADD_FORMAT \
+	"stack[i%+d] = (stack[i%+d] %c %d) & MASK\n"
 
 /**
- * @def PYTHON_LEFT
- * @brief Chaîne de caractères représentant l'instruction de déplacement vers la
+ * @def PYTHON_SET_FORMAT
+ * @brief Format représentant l'affectation d'une constante à une case d'un
+ * programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_SET_FORMAT \
+	"stack[i%+d] = %" PRIu32 "\n"
+
+/**
+ * @def PYTHON_MUL_FORMAT
+ * @brief Format représentant la multiplication-addition vers une case décalée
+ * d'un programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_MUL_FORMAT \
+	"stack[i%+d] = (stack[i%+d] + stack[i%+d] * %d) & MASK\n"
+
+/**
+ * @def PYTHON_LEFT_FORMAT
+ * @brief Format représentant l'instruction de déplacement vers la
  * gauche d'un programme Brainfuck convertis en programme python.
  * 
  */
-#define PYTHON_LEFT \
-	"i -= 1\n"
+#define PYTHON_LEFT_FORMAT \
+	"i -= %d\n"
 
 /**
- * @def PYTHON_RIGHT
- * @brief Chaîne de caractères représentant l'instruction de déplacement vers la
+ * @def PYTHON_RIGHT_FORMAT
+ * @brief Format représentant l'instruction de déplacement vers la
  * droite d'un programme Brainfuck convertis en programme python.
  * 
  */
-#define PYTHON_RIGHT \
-	"i += 1\n"
+#define PYTHON_RIGHT_FORMAT \
+	"i += %d\n"
 
 /**
- * @def PYTHON_PUT
- * @brief Chaîne de caractères représentant l'instruction d'écriture d'un
- * programme Brainfuck convertis en programme python.
+ * @def PYTHON_PUT_FORMAT
+ * @brief Format représentant l'instruction d'écriture d'un programme
+ * Brainfuck convertis en programme python (cases de 8 bits).
  * 
  */
-#define PYTHON_PUT \
-	"print(chr(stack[i]), end=\"\")\n"
+#define PYTHON_PUT_FORMAT \
+	"out.append(stack[i%+d])\n"
 
 /**
- * @def PYTHON_GET
- * @brief Chaîne de caractères représentant l'instruction de lecture d'un
+ * @def PYTHON_WIDE_PUT_FORMAT
+ * @brief Format représentant l'instruction d'écriture d'un programme
+ * Brainfuck convertis en programme python (cases de 16 ou 32 bits, dont seul
+ * l'octet de poids faible est écrit, comme par putchar).
+ * 
+ */
+#define PYTHON_WIDE_PUT_FORMAT \
+	"out.append(stack[i%+d] & 0xFF)\n"
+
+/**
+ * @def PYTHON_PUT_FLUSH
+ * @brief Chaîne de caractères représentant le vidage du tampon de sortie
+ * plein, après un bloc qui écrit, d'un programme python.
+ * 
+ */
+#define PYTHON_PUT_FLUSH \
+	"if len(out) >= OUTPUT_LENGTH: flush(out)\n"
+
+/**
+ * @def PYTHON_GET_FORMAT
+ * @brief Format représentant l'instruction de lecture d'un
  * programme Brainfuck convertis en programme python.
  * 
  */
-#define PYTHON_GET \
-	"stack[i] = input(1)\n"
+#define PYTHON_GET_FORMAT \
+	"stack[i%+d] = get(out)\n"
+
+/**
+ * @def PYTHON_SCAN_FORMAT
+ * @brief Format représentant la recherche d'une case nulle d'un programme
+ * Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_SCAN_FORMAT \
+	"while stack[i]: i += %d\n"
+
+/**
+ * @def PYTHON_PEVAL_TAPE_FORMAT
+ * @brief Format représentant l'initialisation de la bande par le préfixe
+ * évalué d'un programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_PEVAL_TAPE_FORMAT \
+	"stack[STACK_MARGIN:STACK_MARGIN + %ld] = [\n"
+
+/**
+ * @def PYTHON_PEVAL_PTR_FORMAT
+ * @brief Format représentant la position du pointeur après le préfixe évalué
+ * d'un programme Brainfuck convertis en programme python.
+ * 
+ */
+#define PYTHON_PEVAL_PTR_FORMAT \
+	"i = STACK_MARGIN + %ld\n"
+
+/**
+ * @def PYTHON_PEVAL_OUTPUT_BEGIN
+ * @brief Chaîne de caractères représentant le début de l'écriture d'un bloc
+ * de la sortie du préfixe évalué d'un programme Brainfuck convertis en
+ * programme python.
+ * 
+ */
+#define PYTHON_PEVAL_OUTPUT_BEGIN \
+	"write(\n"
+
+/**
+ * @def PYTHON_PEVAL_OUTPUT_END
+ * @brief Chaîne de caractères représentant la fin de l'écriture d'un bloc de
+ * la sortie du préfixe évalué d'un programme Brainfuck convertis en programme
+ * python.
+ * 
+ */
+#define PYTHON_PEVAL_OUTPUT_END \
+	")\n"
 
 /* ------------------------------------ C ----------------------------------- */
 
 /**
- * @def C_HEADER
- * @brief Chaîne de caractères représentant l'entête d'un programme Brainfuck
- * converti en programme C.
+ * @def C_OUTPUT_LENGTH
+ * @brief Taille (en octets) du tampon de sortie des programmes C générés.
+ * 
+ */
+#define C_OUTPUT_LENGTH 65536
+
+/**
+ * @def C_HEADER_FORMAT
+ * @brief Format représentant l'entête d'un programme Brainfuck converti en
+ * programme C (la taille de la bande dépend des positions atteintes, le type
+ * des cases de leur largeur, puis la taille du tampon de sortie).
  * 
+ * @note La bande est statique, donc nulle, et précédée d'une marge nulle
+ * (voir ASM_TAPE_MARGIN). La sortie est accumulée dans un tampon écrit par
+ * fwrite lorsqu'il est plein, avant chaque lecture et à la fin du programme.
+ * @note Le pointeur est 'restrict' (seul accès à la bande) et les tests de
+ * boucle sont annotés par __builtin_expect sous GCC et Clang.
  */
-#define C_HEADER \
+#define C_HEADER_FORMAT \
 	"#include <stdio.h>\n" \
-	"#include <stdlib.h>\n\n" \
-	"#define STACK_LENGTH 32000\n\n" \
+	"#include <stdint.h>\n" \
+	"#include <string.h>\n\n" \
+	"#define STACK_LENGTH %ld\n" \
+	"#define OUTPUT_LENGTH %d\n\n" \
+	"#if defined(__GNUC__)\n" \
+	"#define likely(x) __builtin_expect(!!(x), 1)\n" \
+	"#define unlikely(x) __builtin_expect(!!(x), 0)\n" \
+	"#else\n" \
+	"#define likely(x) (x)\n" \
+	"#define unlikely(x) (x)\n" \
+	"#endif\n\n" \
+	"typedef %s cell;\n\n" \
+	"#define STACK_MARGIN (4096 / sizeof(cell))\n\n" \
+	"static cell stack[STACK_MARGIN + STACK_LENGTH];\n" \
+	"static unsigned char output[OUTPUT_LENGTH];\n" \
+	"static size_t output_length;\n\n" \
+	"static void bf_flush(void) {\n" \
+	"\tfwrite(output, 1, output_length, stdout);\n" \
+	"\toutput_length = 0;\n" \
+	"}\n\n" \
+	"static inline void bf_put(cell value) {\n" \
+	"\toutput[output_length++] = (unsigned char)value;\n" \
+	"\tif (unlikely(output_length == OUTPUT_LENGTH)) bf_flush();\n" \
+	"}\n\n" \
+	"static inline cell bf_get(void) {\n" \
+	"\tbf_flush();\n" \
+	"\tfflush(stdout);\n" \
+	"\treturn (cell)getchar();\n" \
+	"}\n\n" \
 	"int main(void) {\n" \
-	"\tint *stack = malloc(STACK_LENGTH * sizeof(int));\n" \
-	"\tint *ptr = stack;\n"
+	"\tcell *restrict ptr = stack + STACK_MARGIN;\n"
 
 /**
  * @def C_FOOTER
  * @brief Chaîne de caractères représentant le pied d'un programme Brainfuck
- * converti en programme C.
+ * converti en programme C (vidage du tampon de sortie).
  * 
  */
 #define C_FOOTER \
+	"\tbf_flush();\n" \
+	"\treturn 0;\n" \
 	"}\n"
 
 /**
@@ -178,7 +433,7 @@
  * 
  */
 #define C_LOOP_BEGIN \
-	"while (*ptr) {\n"
+	"while (likely(*ptr)) {\n"
 
 /**
  * @brief Chaîne de caractères représentant la fin d'une boucle d'un programme
@@ -189,58 +444,656 @@
 	"}\n"
 
 /**
- * @def C_INC
- * @brief Chaîne de caractères représentant l'instruction d'incrémentation d'un
+ * @def C_INC_FORMAT
+ * @brief Format représentant l'instruction d'incrémentation d'un
  * programme Brainfuck converti en programme C.
  * 
  */
-#define C_INC \
-	"*ptr++;\n"
+#define C_INC_FORMAT \
+	"ptr[%d] += %d;\n"
 
 /**
- * @def C_DEC
- * @brief Chaîne de caractères représentant l'instruction de décrémentation d'un
+ * @def C_DEC_FORMAT
+ * @brief Format représentant l'instruction de décrémentation d'un
  * programme Brainfuck converti en programme C.
  * 
  */
-#define C_DEC \
-	"*ptr--;\n"
+#define C_DEC_FORMAT \
+	"ptr[%d] -= %d;\n"
 
 /**
- * @def C_LEFT
- * @brief Chaîne de caractères représentant l'instruction de déplacement vers la
+ * @def C_LEFT_FORMAT
+ * @brief Format représentant l'instruction de déplacement vers la
  * gauche d'un programme Brainfuck converti en programme C.
  * 
  */
-#define C_LEFT \
-	"ptr--;\n"
+#define C_LEFT_FORMAT \
+	"ptr -= %d;\n"
 
 /**
- * @def C_RIGHT
- * @brief Chaîne de caractères représentant l'instruction de déplacement vers la
+ * @def C_RIGHT_FORMAT
+ * @brief Format représentant l'instruction de déplacement vers la
  * droite d'un programme Brainfuck converti en programme C.
  * 
  */
-#define C_RIGHT \
-	"ptr++;\n"
+#define C_RIGHT_FORMAT \
+	"ptr += %d;\n"
 
 /**
- * @def C_PUT
- * @brief Chaîne de caractères représentant l'instruction d'écriture d'un
+ * @def C_PUT_FORMAT
+ * @brief Format représentant l'instruction d'écriture d'un
  * programme Brainfuck converti en programme C.
  * 
  */
-#define C_PUT \
-	"putchar(*ptr);\n"
+#define C_PUT_FORMAT \
+	"bf_put(ptr[%d]);\n"
 
 /**
- * @def C_GET
- * @brief Chaîne de caractères représentant l'instruction de lecture d'un
+ * @def C_GET_FORMAT
+ * @brief Format représentant l'instruction de lecture d'un
  * programme Brainfuck converti en programme C.
  * 
  */
-#define C_GET \
-	"*ptr = getchar();\n"
+#define C_GET_FORMAT \
+	"ptr[%d] = bf_get();\n"
+
+/**
+ * @def C_SET_FORMAT
+ * @brief Format représentant l'affectation d'une constante à une case d'un
+ * programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_SET_FORMAT \
+	"ptr[%d] = %" PRIu32 ";\n"
+
+/**
+ * @def C_SCAN_FORMAT
+ * @brief Format représentant la recherche d'une case nulle d'un programme
+ * Brainfuck converti en programme C.
+ * 
+ */
+#define C_SCAN_FORMAT \
+	"while (*ptr) ptr += %d;\n"
+
+/**
+ * @def C_MUL_FORMAT
+ * @brief Format représentant la multiplication-addition vers une case décalée
+ * d'un programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_MUL_FORMAT \
+	"ptr[%d] += *ptr * %d;\n"
+
+/**
+ * @def C_VECTOR_FORMAT
+ * @brief Format représentant le vecteur de constantes d'une suite d'ajouts
+ * ou d'affectations à des cases consécutives d'un programme Brainfuck
+ * converti en programme C (voir block_run).
+ * 
+ */
+#define C_VECTOR_FORMAT \
+	"static const cell vector[%d] = {"
+
+/**
+ * @def C_VECTOR_ADD_FORMAT
+ * @brief Format représentant l'ajout d'un vecteur de constantes à des cases
+ * consécutives d'un programme Brainfuck converti en programme C (boucle que
+ * le compilateur C vectorise).
+ * 
+ */
+#define C_VECTOR_ADD_FORMAT \
+	"for (int k = 0; k < %d; k++) ptr[%d + k] += vector[k];\n"
+
+/**
+ * @def C_VECTOR_SET_FORMAT
+ * @brief Format représentant l'affectation d'un vecteur de constantes à des
+ * cases consécutives d'un programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_VECTOR_SET_FORMAT \
+	"memcpy(ptr + %d, vector, sizeof(vector));\n"
+
+/**
+ * @def C_VECTOR_CLEAR_FORMAT
+ * @brief Format représentant la remise à zéro de cases consécutives d'un
+ * programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_VECTOR_CLEAR_FORMAT \
+	"memset(ptr + %d, 0, %d * sizeof(cell));\n"
+
+/**
+ * @def C_PEVAL_TAPE_FORMAT
+ * @brief Format représentant les valeurs initiales de la bande (préfixe
+ * évalué) d'un programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_PEVAL_TAPE_FORMAT \
+	"static const cell tape_init[%ld] = {\n"
+
+/**
+ * @def C_PEVAL_COPY
+ * @brief Chaîne de caractères représentant la copie des valeurs initiales
+ * dans la bande d'un programme Brainfuck converti en programme C (par le
+ * pointeur, seul accès à la bande).
+ * 
+ */
+#define C_PEVAL_COPY \
+	"memcpy(ptr, tape_init, sizeof(tape_init));\n"
+
+/**
+ * @def C_PEVAL_OUTPUT_BEGIN
+ * @brief Chaîne de caractères représentant le début de l'écriture d'un bloc
+ * de la sortie du préfixe évalué d'un programme Brainfuck converti en
+ * programme C.
+ * 
+ */
+#define C_PEVAL_OUTPUT_BEGIN \
+	"fwrite(\n"
+
+/**
+ * @def C_PEVAL_OUTPUT_END_FORMAT
+ * @brief Format représentant la fin de l'écriture d'un bloc de la sortie du
+ * préfixe évalué d'un programme Brainfuck converti en programme C.
+ * 
+ */
+#define C_PEVAL_OUTPUT_END_FORMAT \
+	"1, %ld, stdout);\n"
+
+/* ------------------------------- Assembleur ------------------------------- */
+
+/**
+ * @def ASM_BUFFER_LENGTH
+ * @brief Taille (en octets) des tampons d'entrée et de sortie d'un programme
+ * Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_BUFFER_LENGTH 4096
+
+/**
+ * @def ASM_HEADER
+ * @brief Chaîne de caractères représentant l'entête d'un programme Brainfuck
+ * converti en assembleur x86-64 (GNU as, Linux, sans libc) : le pointeur sur
+ * la bande est conservé dans %rbx, la position dans le tampon de sortie dans
+ * %r12, la position et la fin du tampon d'entrée dans %r13 et %r14.
+ * 
+ */
+#define ASM_HEADER \
+	"\t.text\n" \
+	"\t.globl _start\n" \
+	"_start:\n" \
+	"\tleaq tape(%%rip), %%rbx\n" \
+	"\tleaq outbuf(%%rip), %%r12\n" \
+	"\txorl %%r13d, %%r13d\n" \
+	"\txorl %%r14d, %%r14d\n"
+
+/**
+ * @def ASM_FOOTER_FORMAT
+ * @brief Format représentant le pied d'un programme Brainfuck converti en
+ * assembleur : la sortie du programme, puis ses routines d'entrée/sortie
+ * (appels système read et write tamponnés) et ses tampons.
+ * 
+ * @note bf_putc écrit %al dans le tampon de sortie, vidé lorsqu'il est plein,
+ * avant chaque remplissage du tampon d'entrée et à la fin du programme.
+ * @note bf_getc retourne dans %eax l'octet lu, ou -1 en fin de fichier (comme
+ * getchar).
+ */
+#define ASM_FOOTER_FORMAT \
+	"\tcall bf_flush\n" \
+	"\tmovl $60, %%eax\n" \
+	"\txorl %%edi, %%edi\n" \
+	"\tsyscall\n" \
+	"\n" \
+	"bf_write:\n" \
+	"\ttestq %%rdx, %%rdx\n" \
+	"\tjle 1f\n" \
+	"\tmovl $1, %%eax\n" \
+	"\tmovl $1, %%edi\n" \
+	"\tsyscall\n" \
+	"\ttestq %%rax, %%rax\n" \
+	"\tjle 1f\n" \
+	"\taddq %%rax, %%rsi\n" \
+	"\tsubq %%rax, %%rdx\n" \
+	"\tjmp bf_write\n" \
+	"1:\tret\n" \
+	"\n" \
+	"bf_flush:\n" \
+	"\tleaq outbuf(%%rip), %%rsi\n" \
+	"\tmovq %%r12, %%rdx\n" \
+	"\tsubq %%rsi, %%rdx\n" \
+	"\tmovq %%rsi, %%r12\n" \
+	"\tjmp bf_write\n" \
+	"\n" \
+	"bf_putc:\n" \
+	"\tmovb %%al, (%%r12)\n" \
+	"\tincq %%r12\n" \
+	"\tleaq outbuf+%d(%%rip), %%rax\n" \
+	"\tcmpq %%rax, %%r12\n" \
+	"\tje bf_flush\n" \
+	"\tret\n" \
+	"\n" \
+	"bf_getc:\n" \
+	"\tcmpq %%r14, %%r13\n" \
+	"\tjb 1f\n" \
+	"\tcall bf_flush\n" \
+	"\txorl %%eax, %%eax\n" \
+	"\txorl %%edi, %%edi\n" \
+	"\tleaq inbuf(%%rip), %%rsi\n" \
+	"\tmovl $%d, %%edx\n" \
+	"\tsyscall\n" \
+	"\ttestq %%rax, %%rax\n" \
+	"\tjle 2f\n" \
+	"\tleaq inbuf(%%rip), %%r13\n" \
+	"\tleaq (%%r13,%%rax), %%r14\n" \
+	"1:\tmovzbl (%%r13), %%eax\n" \
+	"\tincq %%r13\n" \
+	"\tret\n" \
+	"2:\tmovl $-1, %%eax\n" \
+	"\tret\n" \
+	"\n" \
+	"\t.bss\n" \
+	"outbuf:\t.zero %d\n" \
+	"inbuf:\t.zero %d\n"
+
+/**
+ * @def ASM_TAPE_MARGIN
+ * @brief Nombre d'octets nuls réservés avant la bande d'un programme
+ * Brainfuck converti en assembleur : un programme non borné qui lit juste
+ * avant la première case (comme test/mandelbrot.bf) y trouve des zéros.
+ * 
+ */
+#define ASM_TAPE_MARGIN 4096
+
+/**
+ * @def ASM_TAPE_FORMAT
+ * @brief Format représentant la bande (nulle, précédée de sa marge) d'un
+ * programme Brainfuck converti en assembleur (en octets).
+ * 
+ */
+#define ASM_TAPE_FORMAT \
+	"\t.align 32\n" \
+	"\t.zero %d\n" \
+	"tape:\t.zero %ld\n"
+
+/**
+ * @def ASM_PEVAL_TAPE_FORMAT
+ * @brief Format représentant le début de la bande (précédée de sa marge)
+ * initialisée par le préfixe évalué d'un programme Brainfuck converti en
+ * assembleur, le reste de la bande suivant les valeurs initiales.
+ * 
+ */
+#define ASM_PEVAL_TAPE_FORMAT \
+	"\t.data\n" \
+	"\t.align 32\n" \
+	"\t.zero %d\n" \
+	"tape:\n"
+
+/**
+ * @def ASM_PEVAL_PTR_FORMAT
+ * @brief Format représentant la position du pointeur (en octets) après le
+ * préfixe évalué d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_PEVAL_PTR_FORMAT \
+	"leaq tape+%ld(%%rip), %%rbx\n"
+
+/**
+ * @def ASM_PEVAL_OUTPUT_FORMAT
+ * @brief Format représentant l'écriture d'un bloc de la sortie du préfixe
+ * évalué d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_PEVAL_OUTPUT_FORMAT \
+	"leaq peval_output(%%rip), %%rsi\n" \
+	"\tmovq $%ld, %%rdx\n" \
+	"\tcall bf_write\n"
+
+/**
+ * @def ASM_PEVAL_OUTPUT_BEGIN
+ * @brief Chaîne de caractères représentant le début de la sortie du préfixe
+ * évalué d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_PEVAL_OUTPUT_BEGIN \
+	"\t.section .rodata\n" \
+	"peval_output:\n"
+
+/**
+ * @def ASM_LOOP_BEGIN_FORMAT
+ * @brief Format représentant le début d'une boucle d'un programme Brainfuck
+ * converti en assembleur (la condition est testée avant le premier tour).
+ * 
+ */
+#define ASM_LOOP_BEGIN_FORMAT \
+	"\tcmp%c $0, (%%rbx)\n" \
+	"\tje .L%d_end\n" \
+	".L%d:\n"
+
+/**
+ * @def ASM_LOOP_END_FORMAT
+ * @brief Format représentant la fin d'une boucle d'un programme Brainfuck
+ * converti en assembleur.
+ * 
+ */
+#define ASM_LOOP_END_FORMAT \
+	"\tcmp%c $0, (%%rbx)\n" \
+	"\tjne .L%d\n" \
+	".L%d_end:\n"
+
+/**
+ * @def ASM_MOVE_FORMAT
+ * @brief Format représentant le déplacement du pointeur (en octets) d'un
+ * programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_MOVE_FORMAT \
+	"addq $%d, %%rbx\n"
+
+/**
+ * @def ASM_ADD_FORMAT
+ * @brief Format représentant l'ajout (modulaire) d'une constante à une case
+ * d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_ADD_FORMAT \
+	"add%c $%" PRIu32 ", %d(%%rbx)\n"
+
+/**
+ * @def ASM_SET_FORMAT
+ * @brief Format représentant l'affectation d'une constante à une case d'un
+ * programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_SET_FORMAT \
+	"mov%c $%" PRIu32 ", %d(%%rbx)\n"
+
+/**
+ * @def ASM_LOAD_FORMAT
+ * @brief Format représentant le chargement (étendu à 32 bits) d'une case dans
+ * %eax d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_LOAD_FORMAT \
+	"%s %d(%%rbx), %%eax\n"
+
+/**
+ * @def ASM_FACTOR_FORMAT
+ * @brief Format représentant la multiplication de %eax par le facteur d'une
+ * multiplication-addition d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_FACTOR_FORMAT \
+	"imull $%d, %%eax, %%eax\n"
+
+/**
+ * @def ASM_STORE_FORMAT
+ * @brief Format représentant l'ajout, le retrait ou l'écriture de %eax (à la
+ * largeur des cases) dans une case d'un programme Brainfuck converti en
+ * assembleur.
+ * 
+ */
+#define ASM_STORE_FORMAT \
+	"%s%c %%%s, %d(%%rbx)\n"
+
+/**
+ * @def ASM_PUT_FORMAT
+ * @brief Format représentant l'instruction d'écriture d'un programme
+ * Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_PUT_FORMAT \
+	"movb %d(%%rbx), %%al\n" \
+	"\tcall bf_putc\n"
+
+/**
+ * @def ASM_GET
+ * @brief Chaîne de caractères représentant la lecture d'un octet dans %eax
+ * d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_GET \
+	"call bf_getc\n"
+
+/**
+ * @def ASM_SCAN_FORMAT
+ * @brief Format représentant la recherche d'une case nulle (pas en octets)
+ * d'un programme Brainfuck converti en assembleur.
+ * 
+ */
+#define ASM_SCAN_FORMAT \
+	"\tcmp%c $0, (%%rbx)\n" \
+	"\tje .L%d_end\n" \
+	".L%d:\n" \
+	"\taddq $%d, %%rbx\n" \
+	"\tcmp%c $0, (%%rbx)\n" \
+	"\tjne .L%d\n" \
+	".L%d_end:\n"
+
+/* ---------------------------------- LLVM ---------------------------------- */
+
+/**
+ * @def LLVM_TAPE_MARGIN
+ * @brief Nombre d'octets nuls réservés avant la bande d'un programme
+ * Brainfuck converti en LLVM IR (voir ASM_TAPE_MARGIN).
+ * 
+ */
+#define LLVM_TAPE_MARGIN 4096
+
+/**
+ * @def LLVM_HEADER_FORMAT
+ * @brief Format représentant l'entête d'un programme Brainfuck converti en
+ * LLVM IR : les entrées/sorties (tamponnées) sont celles de la bibliothèque C,
+ * et le pointeur sur la bande est une variable locale (%ptr) que mem2reg
+ * promeut en registre. Le pointeur est initialisé à la position donnée (en
+ * octets depuis le début de la marge).
+ * 
+ */
+#define LLVM_HEADER_FORMAT \
+	"; Programme Brainfuck converti en LLVM IR (pointeurs opaques)\n\n" \
+	"declare i32 @putchar(i32)\n" \
+	"declare i32 @getchar()\n\n" \
+	"define i32 @main() {\n" \
+	"entry:\n" \
+	"\t%%ptr = alloca ptr, align 8\n" \
+	"\tstore ptr getelementptr inbounds (i8, ptr @tape, i64 %ld), " \
+	"ptr %%ptr, align 8\n"
+
+/**
+ * @def LLVM_FOOTER
+ * @brief Chaîne de caractères représentant le pied de la fonction principale
+ * d'un programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_FOOTER \
+	"\tret i32 0\n" \
+	"}\n\n"
+
+/**
+ * @def LLVM_TAPE_FORMAT
+ * @brief Format représentant la bande (nulle, marge comprise) d'un programme
+ * Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_TAPE_FORMAT \
+	"@tape = internal global [%ld x %s] zeroinitializer, align 32\n"
+
+/**
+ * @def LLVM_PEVAL_TAPE_FORMAT
+ * @brief Format représentant le début de la bande (marge, valeurs initiales,
+ * reste nul) initialisée par le préfixe évalué d'un programme Brainfuck
+ * converti en LLVM IR.
+ * 
+ */
+#define LLVM_PEVAL_TAPE_FORMAT \
+	"@tape = internal global <{ [%ld x %s], [%ld x %s], [%ld x %s] }> <{\n" \
+	"\t[%ld x %s] zeroinitializer,\n" \
+	"\t[%ld x %s] [\n"
+
+/**
+ * @def LLVM_PEVAL_TAPE_END_FORMAT
+ * @brief Format représentant la fin de la bande initialisée par le préfixe
+ * évalué d'un programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_PEVAL_TAPE_END_FORMAT \
+	"\t],\n" \
+	"\t[%ld x %s] zeroinitializer\n" \
+	"}>, align 32\n"
+
+/**
+ * @def LLVM_PEVAL_OUTPUT_FORMAT
+ * @brief Format représentant l'écriture de la sortie du préfixe évalué d'un
+ * programme Brainfuck converti en LLVM IR (boucle sur la constante
+ * @peval_output de la longueur donnée).
+ * 
+ */
+#define LLVM_PEVAL_OUTPUT_FORMAT \
+	"\tbr label %%peval\n" \
+	"peval:\n" \
+	"\t%%i = phi i64 [0, %%entry], [%%i.next, %%peval]\n" \
+	"\t%%c.ptr = getelementptr inbounds [%ld x i8], ptr @peval_output, " \
+	"i64 0, i64 %%i\n" \
+	"\t%%c = load i8, ptr %%c.ptr, align 1\n" \
+	"\t%%c.int = zext i8 %%c to i32\n" \
+	"\tcall i32 @putchar(i32 %%c.int)\n" \
+	"\t%%i.next = add i64 %%i, 1\n" \
+	"\t%%done = icmp eq i64 %%i.next, %ld\n" \
+	"\tbr i1 %%done, label %%start, label %%peval\n" \
+	"start:\n"
+
+/**
+ * @def LLVM_PEVAL_OUTPUT_BEGIN_FORMAT
+ * @brief Format représentant le début de la constante de la sortie du préfixe
+ * évalué d'un programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_PEVAL_OUTPUT_BEGIN_FORMAT \
+	"@peval_output = private unnamed_addr constant [%ld x i8] c\""
+
+/**
+ * @def LLVM_LOOP_BEGIN_FORMAT
+ * @brief Format représentant le début d'une boucle d'un programme Brainfuck
+ * converti en LLVM IR : le bloc de test (qui recharge le pointeur), puis
+ * l'étiquette du corps.
+ * 
+ */
+#define LLVM_LOOP_BEGIN_FORMAT \
+	"\tbr label %%L%d\n" \
+	"L%d:\n" \
+	"\t%%t%d = load ptr, ptr %%ptr, align 8\n" \
+	"\t%%t%d = load %s, ptr %%t%d, align %d\n" \
+	"\t%%t%d = icmp ne %s %%t%d, 0\n" \
+	"\tbr i1 %%t%d, label %%L%d.body, label %%L%d.end\n" \
+	"L%d.body:\n"
+
+/**
+ * @def LLVM_LOOP_END_FORMAT
+ * @brief Format représentant la fin d'une boucle d'un programme Brainfuck
+ * converti en LLVM IR.
+ * 
+ */
+#define LLVM_LOOP_END_FORMAT \
+	"\tbr label %%L%d\n" \
+	"L%d.end:\n"
+
+/**
+ * @def LLVM_BASE_FORMAT
+ * @brief Format représentant le chargement du pointeur à l'entrée d'un bloc
+ * de base d'un programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_BASE_FORMAT \
+	"%%t%d = load ptr, ptr %%ptr, align 8\n"
+
+/**
+ * @def LLVM_CELL_FORMAT
+ * @brief Format représentant l'adresse d'une case décalée d'un programme
+ * Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_CELL_FORMAT \
+	"%%t%d = getelementptr inbounds %s, ptr %%t%d, i64 %d\n"
+
+/**
+ * @def LLVM_MOVE_FORMAT
+ * @brief Format représentant l'enregistrement du pointeur déplacé d'un
+ * programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_MOVE_FORMAT \
+	"store ptr %%t%d, ptr %%ptr, align 8\n"
+
+/**
+ * @def LLVM_LOAD_FORMAT
+ * @brief Format représentant la lecture d'une case d'un programme Brainfuck
+ * converti en LLVM IR.
+ * 
+ */
+#define LLVM_LOAD_FORMAT \
+	"%%t%d = load %s, ptr %%t%d, align %d\n"
+
+/**
+ * @def LLVM_STORE_FORMAT
+ * @brief Format représentant l'écriture d'une valeur dans une case d'un
+ * programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_STORE_FORMAT \
+	"store %s %%t%d, ptr %%t%d, align %d\n"
+
+/**
+ * @def LLVM_SET_FORMAT
+ * @brief Format représentant l'affectation d'une constante à une case d'un
+ * programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_SET_FORMAT \
+	"store %s %d, ptr %%t%d, align %d\n"
+
+/**
+ * @def LLVM_BINARY_FORMAT
+ * @brief Format représentant une opération (add, mul) entre une valeur et une
+ * constante d'un programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_BINARY_FORMAT \
+	"%%t%d = %s %s %%t%d, %d\n"
+
+/**
+ * @def LLVM_SUM_FORMAT
+ * @brief Format représentant la somme de deux valeurs d'un programme
+ * Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_SUM_FORMAT \
+	"%%t%d = add %s %%t%d, %%t%d\n"
+
+/**
+ * @def LLVM_CAST_FORMAT
+ * @brief Format représentant la conversion (zext, trunc) d'une valeur d'un
+ * programme Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_CAST_FORMAT \
+	"%%t%d = %s %s %%t%d to %s\n"
+
+/**
+ * @def LLVM_PUT_FORMAT
+ * @brief Format représentant l'instruction d'écriture d'un programme
+ * Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_PUT_FORMAT \
+	"call i32 @putchar(i32 %%t%d)\n"
+
+/**
+ * @def LLVM_GET_FORMAT
+ * @brief Format représentant l'instruction de lecture d'un programme
+ * Brainfuck converti en LLVM IR.
+ * 
+ */
+#define LLVM_GET_FORMAT \
+	"%%t%d = call i32 @getchar()\n"
 
 /* -------------------------------------------------------------------------- */
 /*                                 CONSTANTES                                 */
@@ -256,9 +1109,35 @@ enum COMPILER_MODES {
 	CMODE_CPC,	///< Compilation de Brainfuck brut vers du python.
 	CMODE_BPC,	///< Compilation de Brainfuck bytecode vers du Python.
 	CMODE_CCC,	///< Compilation de Brainfuck brut vers du C.
-	CMODE_BCC	///< Compilation de Brainfuck bytecode vers du C.
+	CMODE_BCC,	///< Compilation de Brainfuck bytecode vers du C.
+	CMODE_CAC,	///< Compilation de Brainfuck brut vers de l'assembleur.
+	CMODE_BAC,	///< Compilation de Brainfuck bytecode vers de l'assembleur.
+	CMODE_CLC,	///< Compilation de Brainfuck brut vers du LLVM IR.
+	CMODE_BLC,	///< Compilation de Brainfuck bytecode vers du LLVM IR.
+	CMODE_CEC,	///< Compilation de Brainfuck brut vers un exécutable ELF.
+	CMODE_BEC,	///< Compilation de Brainfuck bytecode vers un exécutable ELF.
+	CMODE_CMC,	///< Compilation de Brainfuck brut vers du Brainfuck minimal.
+	CMODE_BMC	///< Compilation de Brainfuck bytecode vers du Brainfuck minimal.
 };
 
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Pyhelpers
+ * @struct Pyhelpers
+ * @brief Structure représentant la file des boucles trop profondes d'un
+ * programme Python, converties en fonctions auxiliaires (voir
+ * PYTHON_NESTING_LIMIT).
+ * 
+ */
+typedef struct Pyhelpers {
+	Block **loops;	///< Boucles, dans l'ordre de leurs fonctions.
+	int length;		///< Nombre de boucles.
+	int capacity;	///< Capacité du tableau de boucles.
+} Pyhelpers;
+
 /* -------------------------------------------------------------------------- */
 /*                          PROTOTYPES DES FONCTIONS                          */
 /* -------------------------------------------------------------------------- */
@@ -285,6 +1164,28 @@ extern void ast_to_c(FILE *out, Asttree tree);
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck en
+ * un programme assembleur x86-64 (GNU as, Linux, sans libc).
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ */
+extern void ast_to_asm(FILE *out, Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck en
+ * un module LLVM IR textuel.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ */
+extern void ast_to_llvm(FILE *out, Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * @brief Compile un programme Brainfuck.
  * 
@@ -12,6 +12,7 @@
 
 #include "brainfuck.h"
 #include "parser.h"
+#include "optimizer.h"
 #include "parser_ast.tab.h"
 
 /* -------------------------------------------------------------------------- */
@@ -96,6 +97,28 @@ extern void ast_to_brainfuck(FILE *out, Asttree tree);
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Met un arbre de syntaxe abstraite sous la forme canonique attendue
+ * par ast_to_minified (code mort supprimé, adressage par décalage).
+ * 
+ * @param tree L'arbre à simplifier.
+ * @return Asttree L'arbre simplifié.
+ */
+extern Asttree ast_minify(Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck
+ * (simplifié par ast_minify) en programme Brainfuck minimal.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ */
+extern void ast_to_minified(FILE *out, Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * @brief Décompile le bytecode d'un programme Brainfuck.
  * 
@@ -0,0 +1,99 @@
+/**
+ * @file elf.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'écriture directe d'un exécutable ELF x86-64
+ * statique (Linux, sans libc) à partir des blocs de base d'un programme
+ * Brainfuck, sans assembleur, éditeur de liens ni compilateur C.
+ * @date 2024-05-25
+ * 
+ * 
+ */
+#ifndef _ELF_H_
+#define _ELF_H_
+
+#include <stdint.h>
+
+#include "brainfuck.h"
+#include "jit.h"
+#include "block.h"
+#include "peval.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def ELF_BASE_ADDRESS
+ * @brief Adresse à laquelle est chargé le segment de code (en-têtes, données
+ * constantes, puis code machine) de l'exécutable.
+ * 
+ */
+#define ELF_BASE_ADDRESS 0x400000
+
+/**
+ * @def ELF_BSS_ADDRESS
+ * @brief Adresse du segment de données nulles (tampons d'entrée/sortie, puis
+ * bande) de l'exécutable.
+ * 
+ * @note Le code machine adresse ce segment par des adresses absolues de 32
+ * bits : le segment de code doit se terminer avant, et celui-ci avant 2 Go.
+ */
+#define ELF_BSS_ADDRESS 0x20000000
+
+/**
+ * @def ELF_PAGE_SIZE
+ * @brief Alignement des segments de l'exécutable.
+ * 
+ */
+#define ELF_PAGE_SIZE 0x1000
+
+/**
+ * @def ELF_HEADERS_SIZE
+ * @brief Taille de l'en-tête ELF (64 octets) et des trois en-têtes de
+ * programme (56 octets chacun) : code, données nulles et pile.
+ * 
+ */
+#define ELF_HEADERS_SIZE (64 + 3 * 56)
+
+/**
+ * @def ELF_BUFFER_LENGTH
+ * @brief Taille (en octets) des tampons d'entrée et de sortie de
+ * l'exécutable.
+ * 
+ */
+#define ELF_BUFFER_LENGTH 4096
+
+/**
+ * @def ELF_TAPE_MARGIN
+ * @brief Nombre d'octets nuls réservés avant la bande de l'exécutable (voir
+ * ASM_TAPE_MARGIN).
+ * 
+ */
+#define ELF_TAPE_MARGIN 4096
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit l'exécutable ELF x86-64 statique d'un programme en blocs de
+ * base sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie (ouvert en binaire).
+ * @param blocks Le programme en blocs de base (reste du programme après le
+ * préfixe évalué).
+ * @param pe Le résultat de l'évaluation partielle (sortie du préfixe, bande
+ * et position de départ).
+ * @param cells Le nombre de cases de la bande.
+ * 
+ * @note Le code machine est celui du programme assembleur (voir
+ * ast_to_asm) : mêmes registres, mêmes routines d'entrée/sortie tamponnées par
+ * les appels système read et write.
+ * @note Un exécutable dont les segments dépassent les adresses de 32 bits
+ * provoquera une erreur.
+ */
+extern void elf_program(FILE *out, Block *blocks, Peval pe, long cells);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
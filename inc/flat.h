@@ -0,0 +1,238 @@
+/**
+ * @file flat.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la représentation linéaire (bytecode plat) d'un
+ * programme Brainfuck, obtenue par abaissement de sa représentation en blocs
+ * de base.
+ * @date 2024-05-02
+ * 
+ * 
+ */
+#ifndef _FLAT_H_
+#define _FLAT_H_
+
+#include "brainfuck.h"
+#include "block.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def FLAT_INITIAL_CAPACITY
+ * @brief Capacité initiale (en nombre d'instructions) d'un programme linéaire.
+ * 
+ */
+#define FLAT_INITIAL_CAPACITY 256
+
+/**
+ * @def FLAT_EMPTY
+ * @brief Programme linéaire vide.
+ * 
+ */
+#define FLAT_EMPTY (Flatprog){ \
+	.code = NULL, .nodes = NULL, .length = 0, .capacity = 0, \
+	.vectors = NULL, .nvectors = 0 \
+}
+
+/**
+ * @def FLAT_OPS_STRINGS
+ * @brief Ensemble des chaînes de caractères associées à chaque code
+ * d'opération d'un programme linéaire.
+ * 
+ * @note Les chaînes doivent OBLIGATOIREMENT être dans le même ordre que l'énu-
+ * mération qui définit les codes d'opérations.
+ * 
+ * @see FLAT_OPS
+ */
+#define FLAT_OPS_STRINGS { \
+	"ADD", "MOVE", "PUT", "GET", "JZ", "JNZ", "END", \
+	"CLEAR", "SCAN", "MUL", "VADD", "VSET", \
+	FLAT_SUPER_PAIRS(FLAT_PAIR_STRING) \
+	FLAT_SUPER_TRIPLES(FLAT_TRIPLE_STRING) \
+}
+
+/*
+ * Superinstructions : une superinstruction exécute, en une seule distribution,
+ * une suite de deux ou trois instructions consécutives. Seules les suites
+ * dont les premières instructions ne sont pas des sauts disposent d'un
+ * gestionnaire :
+ * 
+ * - tête (FLAT_SUPER_HEAD, FLAT_SUPER_MID) : ADD, MOVE, CLEAR, MUL ;
+ * - fin  (FLAT_SUPER_TAIL)                 : les mêmes, ainsi que JZ et JNZ.
+ * 
+ * FLAT_SUPER_PAIRS(X) développe X(a, b) et FLAT_SUPER_TRIPLES(X) développe
+ * X(a, b, c) pour chacune de ces suites, toujours dans le même ordre : celui
+ * des codes d'opérations qui suivent F_VSET. Le choix des suites effectivement
+ * fusionnées est fait à partir d'un profil (voir super.h).
+ */
+#define FLAT_SUPER_HEAD(X, ...) \
+	X(__VA_ARGS__, ADD) X(__VA_ARGS__, MOVE) X(__VA_ARGS__, CLEAR) \
+	X(__VA_ARGS__, MUL)
+#define FLAT_SUPER_MID(X, ...) \
+	X(__VA_ARGS__, ADD) X(__VA_ARGS__, MOVE) X(__VA_ARGS__, CLEAR) \
+	X(__VA_ARGS__, MUL)
+#define FLAT_SUPER_TAIL(X, ...) \
+	X(__VA_ARGS__, ADD) X(__VA_ARGS__, MOVE) X(__VA_ARGS__, CLEAR) \
+	X(__VA_ARGS__, MUL) X(__VA_ARGS__, JZ) X(__VA_ARGS__, JNZ)
+
+#define FLAT_SUPER_PAIR_(X, a) FLAT_SUPER_TAIL(X, a)
+#define FLAT_SUPER_TRIPLE_(X, a) FLAT_SUPER_MID(FLAT_SUPER_TRIPLE__, X, a)
+#define FLAT_SUPER_TRIPLE__(X, a, b) FLAT_SUPER_TAIL(X, a, b)
+
+#define FLAT_SUPER_PAIRS(X) FLAT_SUPER_HEAD(FLAT_SUPER_PAIR_, X)
+#define FLAT_SUPER_TRIPLES(X) FLAT_SUPER_HEAD(FLAT_SUPER_TRIPLE_, X)
+
+#define FLAT_PAIR_OP(a, b) F_##a##_##b,
+#define FLAT_TRIPLE_OP(a, b, c) F_##a##_##b##_##c,
+#define FLAT_PAIR_STRING(a, b) #a "+" #b,
+#define FLAT_TRIPLE_STRING(a, b, c) #a "+" #b "+" #c,
+
+/**
+ * @def FLAT_BASE_OPS
+ * @brief Nombre de codes d'opérations de base (hors superinstructions).
+ * 
+ */
+#define FLAT_BASE_OPS (F_VSET + 1)
+
+/* -------------------------------------------------------------------------- */
+/*                                 CONSTANTES                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @enum FLAT_OPS
+ * @brief Énumération des codes d'opérations d'un programme linéaire.
+ * 
+ * @note Les incrémentations/décrémentations et les déplacements à droite/à
+ * gauche sont fusionnés en une seule opération dont l'argument est signé.
+ */
+enum FLAT_OPS {
+	F_ADD ,  ///< Ajout de 'arg' à la case de données située à 'offset'.
+	F_MOVE,  ///< Déplacement de 'arg' cases du pointeur de données.
+	F_PUT ,  ///< Affichage ('arg' fois) de la donnée située à 'offset'.
+	F_GET ,  ///< Récupération ('arg' fois) d'une entrée dans la case 'offset'.
+	F_JZ  ,  ///< Saut vers l'instruction 'arg' ("]") si la donnée est nulle.
+	F_JNZ ,  ///< Saut vers l'instruction 'arg' ("[") si la donnée est non nulle.
+	F_END ,  ///< Fin du programme.
+	F_CLEAR, ///< Affectation de 'arg' (0 : remise à zéro) à la case de
+			 ///< données située à 'offset'.
+	F_SCAN,  ///< Déplacement par pas de 'arg' jusqu'à une case nulle.
+	F_MUL,   ///< Ajout de la case pointée multipliée par 'arg' à la case
+			 ///< située à 'offset' cases.
+	F_VADD,  ///< Ajout du vecteur de constantes 'arg' aux cases consécutives
+			 ///< qui commencent à 'offset'.
+	F_VSET,  ///< Affectation du vecteur de constantes 'arg' aux cases
+			 ///< consécutives qui commencent à 'offset'.
+	FLAT_SUPER_PAIRS(FLAT_PAIR_OP)		// F_ADD_ADD, F_ADD_MOVE, ...
+	FLAT_SUPER_TRIPLES(FLAT_TRIPLE_OP)	// F_ADD_ADD_ADD, ...
+	F_OPS_COUNT ///< Nombre de codes d'opérations.
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Flatinst
+ * @struct Flatinst
+ * @brief Structure représentant une instruction d'un programme linéaire.
+ * 
+ * @note Pour les sauts, 'arg' contient l'indice de l'instruction de saut
+ * associée (celle du crochet correspondant).
+ * @note Pour les sauts, 'offset' contient le décalage minimal (F_JZ) ou
+ * maximal (F_JNZ) des accès de la boucle, relatif à son entrée, si elle est
+ * dans les bornes (voir BOUNDS_IS_KNOWN), -1 sinon.
+ * @note Une superinstruction ne remplace que le code d'opération de la
+ * première instruction de sa suite : les suivantes restent en place (avec
+ * leurs arguments), si bien que les indices de saut ne changent pas.
+ */
+typedef struct Flatinst {
+	int op;		///< Code d'opération.
+	int arg;	///< Argument de l'opération.
+	int offset;	///< Décalage de la case visée par rapport au pointeur.
+} Flatinst;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Flatvec
+ * @struct Flatvec
+ * @brief Structure représentant un vecteur de constantes d'un programme
+ * linéaire (instructions F_VADD et F_VSET).
+ * 
+ * @note Les constantes ont la largeur des cases du programme (voir
+ * FLAG_CELL_BITS) ; un vecteur d'affectation entièrement nul n'en a pas
+ * ('values' vaut NULL) et se réduit à une remise à zéro (memset).
+ */
+typedef struct Flatvec {
+	void *values;	///< Constantes du vecteur, ou NULL.
+	int length;		///< Nombre de cases du vecteur.
+} Flatvec;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Flatprog
+ * @struct Flatprog
+ * @brief Structure représentant un programme linéaire : un tableau contigu
+ * d'instructions terminé par l'instruction F_END.
+ * 
+ * @note Le tableau 'nodes' associe à chaque saut la boucle de l'arbre dont il
+ * est issu (NULL pour les autres instructions) ; il n'est pas lu par la
+ * machine virtuelle mais permet de retrouver la boucle d'un saut.
+ */
+typedef struct Flatprog {
+	Flatinst *code;		///< Instructions du programme.
+	Asttree *nodes;		///< Noeuds d'origine des instructions.
+	int length;			///< Nombre d'instructions du programme.
+	int capacity;		///< Nombre d'instructions allouées.
+	Flatvec *vectors;	///< Vecteurs de constantes du programme.
+	int nvectors;		///< Nombre de vecteurs de constantes.
+} Flatprog;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne un programme linéaire vide.
+ * 
+ * @return Flatprog Un programme linéaire vide.
+ */
+extern Flatprog flat_empty();
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Abaisse un programme en blocs de base en programme linéaire.
+ * 
+ * @param prog Le premier noeud du programme en blocs de base.
+ * @return Flatprog Le programme linéaire correspondant, terminé par F_END.
+ * 
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+extern Flatprog flat(Block *prog);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un programme linéaire.
+ * 
+ * @param progp Le pointeur vers le programme à libérer.
+ */
+extern void flat_free(Flatprog *progp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime un programme linéaire sur la sortie spécifiée sous un format
+ * lisible pour l'oeil humain.
+ * 
+ * @param prog Le programme à imprimer.
+ * @param out La sortie sur laquelle imprimer le programme (Par défaut, stdout).
+ */
+extern void flat_print(Flatprog prog, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * @file jit.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la compilation à la volée (JIT) d'un arbre de
+ * syntaxe abstraite (AST) Brainfuck en code machine x86-64.
+ * @date 2024-05-11
+ * 
+ * 
+ */
+#ifndef _JIT_H_
+#define _JIT_H_
+
+#include <stdint.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def JIT_AVAILABLE
+ * @brief Vaut 1 si la compilation à la volée est disponible pour la plate-
+ * forme cible (x86-64 sous un système POSIX), 0 sinon.
+ * 
+ */
+#if defined(__x86_64__) && defined(__unix__)
+#define JIT_AVAILABLE 1
+#else
+#define JIT_AVAILABLE 0
+#endif
+
+/**
+ * @def JIT_INITIAL_CAPACITY
+ * @brief Capacité initiale (en octets) du tampon de code machine.
+ * 
+ */
+#define JIT_INITIAL_CAPACITY 4096
+
+/**
+ * @def JIT_EMPTY
+ * @brief Code machine vide.
+ * 
+ */
+#define JIT_EMPTY (Jitcode){ .code = NULL, .size = 0 }
+
+/**
+ * @def JIT_EMIT
+ * @brief Fonction macro ajoutant une suite d'octets littéraux à un tampon.
+ * 
+ */
+#define JIT_EMIT(bufp, ...) do { \
+		const uint8_t _b[] = { __VA_ARGS__ }; \
+		jit_bytes(bufp, _b, sizeof(_b)); \
+	} while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Jitbuffer
+ * @struct Jitbuffer
+ * @brief Structure représentant un tampon de code machine en cours
+ * d'écriture.
+ * 
+ */
+typedef struct Jitbuffer {
+	uint8_t *bytes;		///< Octets écrits.
+	size_t length;		///< Nombre d'octets écrits.
+	size_t capacity;	///< Nombre d'octets alloués.
+	int size;			///< Taille d'une case (1, 2 ou 4 octets).
+	bool count;			///< Comptage des itérations des boucles.
+} Jitbuffer;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Jitruntime
+ * @struct Jitruntime
+ * @brief Structure regroupant les fonctions de l'environnement d'exécution
+ * appelées par le code machine (trampoline).
+ * 
+ * @note Le code machine garde l'adresse de cette structure dans le registre
+ * r12 et appelle ses fonctions de manière indirecte : l'ordre des champs fait
+ * donc partie de l'interface avec le code généré.
+ */
+typedef struct Jitruntime {
+	void (*put)(int value, int count);			///< Écriture ('count' fois).
+	int (*get)(int count);						///< Lecture ('count' fois).
+	void *(*scan)(void *p, int step, int size);	///< Recherche de case nulle.
+	long iterations;							///< Itérations comptées.
+} Jitruntime;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Jitcode
+ * @struct Jitcode
+ * @brief Structure représentant un code machine exécutable.
+ * 
+ * @note La zone mémoire n'est jamais à la fois inscriptible et exécutable
+ * (W^X) : elle est écrite, puis rendue exécutable et non inscriptible.
+ */
+typedef struct Jitcode {
+	void *code;		///< Zone mémoire (mmap) contenant le code machine.
+	size_t size;	///< Taille de la zone mémoire.
+} Jitcode;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute des octets à la fin d'un tampon de code machine.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param bytes Les octets à ajouter.
+ * @param count Le nombre d'octets à ajouter.
+ * 
+ * @note Le tampon est agrandi (doublé) si nécessaire.
+ * @note Les fonctions d'émission ne dépendent pas de JIT_AVAILABLE : elles
+ * servent aussi à l'écriture d'exécutables (voir elf.h).
+ */
+extern void jit_bytes(Jitbuffer *bufp, const uint8_t *bytes, size_t count);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute un entier de 32 bits (petit-boutiste) à la fin d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'entier à ajouter.
+ */
+extern void jit_int32(Jitbuffer *bufp, int32_t value);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Réécrit un entier de 32 bits (petit-boutiste) à une position donnée
+ * d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param at La position de l'entier.
+ * @param value L'entier à écrire.
+ */
+extern void jit_patch32(Jitbuffer *bufp, size_t at, int32_t value);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute un immédiat de la taille d'une case (petit-boutiste) à la fin
+ * d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'immédiat à ajouter (tronqué à la taille d'une case).
+ */
+extern void jit_imm(Jitbuffer *bufp, int32_t value);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute le code d'opération d'une instruction portant sur une case.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param op Le code d'opération 32 bits (81, 89, C7, 01, ...), dont la
+ * variante 8 bits est le code précédent et la variante 16 bits est préfixée
+ * par 66.
+ */
+extern void jit_op(Jitbuffer *bufp, uint8_t op);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute le chargement (avec extension par des zéros) d'une case dans
+ * un registre de 32 bits.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param modrm L'octet ModR/M désignant le registre et la case.
+ */
+extern void jit_load(Jitbuffer *bufp, uint8_t modrm);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute le test à zéro de la case pointée ('cmp [rbx], 0').
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ */
+extern void jit_test(Jitbuffer *bufp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compile un arbre de syntaxe abstraite (AST) en code machine x86-64.
+ * 
+ * @param tree L'arbre à compiler.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return Jitcode Le code machine exécutable correspondant.
+ * 
+ * @note Un type d'arbre inconnu ou un échec d'allocation de la zone mémoire
+ * provoquera une erreur.
+ * @note Si JIT_AVAILABLE vaut 0, un code vide est retourné.
+ */
+extern Jitcode jit(Asttree tree, int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compile une seule boucle (sans ses petits-frères) en code machine
+ * x86-64.
+ * 
+ * @param loop La boucle (A_LOOP) à compiler.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @param count Vaut true si les itérations des boucles doivent être comptées
+ * (voir jit_run).
+ * @return Jitcode Le code machine exécutable correspondant.
+ * 
+ * @note Le code peut être exécuté au début de n'importe quelle itération de la
+ * boucle : il reprend au test de la case pointée.
+ */
+extern Jitcode jit_loop(Asttree loop, int size, bool count);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un code machine sur la bande de données donnée.
+ * 
+ * @param code Le code machine à exécuter.
+ * @param tape La case de départ de la bande de données.
+ * @param iterations Si non NULL, reçoit en plus le nombre d'itérations de
+ * boucles exécutées (code compilé avec comptage uniquement).
+ * @return void* La case pointée à la fin de l'exécution.
+ */
+extern void *jit_run(Jitcode code, void *tape, long *iterations);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un code machine.
+ * 
+ * @param codep Le pointeur vers le code à libérer.
+ */
+extern void jit_free(Jitcode *codep);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
\ No newline at end of file
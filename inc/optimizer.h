@@ -0,0 +1,246 @@
+/**
+ * @file optimizer.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant les passes d'optimisation appliquées à l'arbre de
+ * syntaxe abstraite (AST) d'un programme Brainfuck.
+ * @date 2024-05-04
+ * 
+ * 
+ */
+#ifndef _OPTIMIZER_H_
+#define _OPTIMIZER_H_
+
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def OPT_MAX_CELLS
+ * @brief Nombre maximal de cases distinctes suivies par l'état symbolique de
+ * la bande (un corps de boucle qui en touche davantage n'est pas résumé).
+ * 
+ */
+#define OPT_MAX_CELLS 32
+
+/**
+ * @def OPT_MAX_FACTOR
+ * @brief Valeur absolue maximale du facteur d'une multiplication (A_MUL)
+ * issue d'une boucle dont le pas du compteur n'est pas 1 (au-delà, la boucle
+ * est gardée, sa décompilation restant ainsi de la taille du programme).
+ * 
+ */
+#define OPT_MAX_FACTOR 255
+
+/**
+ * @def OPT_UNROLL_DEFAULT
+ * @brief Facteur de déroulage par défaut des boucles dont le nombre de tours
+ * est connu.
+ * 
+ */
+#define OPT_UNROLL_DEFAULT 8
+
+/**
+ * @def OPT_UNROLL_MAX_NODES
+ * @brief Nombre maximal de noeuds du corps d'une boucle déroulée.
+ * 
+ */
+#define OPT_UNROLL_MAX_NODES 16
+
+/**
+ * @def OPT_DEFAULT_LEVEL
+ * @brief Niveau d'optimisation par défaut (toutes les passes).
+ * 
+ */
+#define OPT_DEFAULT_LEVEL 3
+
+/**
+ * @def OPT_MAX_LEVEL
+ * @brief Niveau d'optimisation maximal.
+ * 
+ */
+#define OPT_MAX_LEVEL 3
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Cellstate
+ * @struct Cellstate
+ * @brief Structure représentant l'état symbolique d'une case de données, à un
+ * décalage donné d'une position de référence.
+ * 
+ */
+typedef struct Cellstate {
+	int offset;		///< Décalage de la case par rapport à la référence.
+	uint32_t value;	///< Valeur de la case si elle est connue, sinon valeur
+					///< ajoutée à sa valeur initiale (modulo 2^n).
+	bool known;		///< Vaut true si la valeur de la case est connue.
+} Cellstate;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Optstate
+ * @struct Optstate
+ * @brief Structure représentant l'état symbolique de la bande : les cases
+ * touchées et la position du pointeur, relatives à une même référence.
+ * 
+ */
+typedef struct Optstate {
+	Cellstate cells[OPT_MAX_CELLS];	///< Cases touchées.
+	int length;						///< Nombre de cases touchées.
+	int cursor;						///< Décalage du pointeur de données.
+	bool blank;						///< Les autres cases sont nulles (sinon
+									///< leur valeur est inconnue).
+} Optstate;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Optpass
+ * @struct Optpass
+ * @brief Structure représentant une passe d'optimisation de l'arbre.
+ * 
+ * @note Les passes sont appliquées dans l'ordre par optimize, à partir de
+ * leur niveau :
+ * - -O1 : suppression du code mort, adressage par décalage ;
+ * - -O2 : remplacement des boucles idiomatiques ;
+ * - -O3 : déroulage des boucles dont le nombre de tours est connu.
+ * À -O0, seules les répétitions d'une même instruction sont regroupées (par
+ * l'analyseur).
+ */
+typedef struct Optpass {
+	char *name;		///< Nom de la passe.
+	int level;		///< Niveau minimal auquel la passe est appliquée.
+	Asttree (*run)(Asttree tree, int *changesp);	///< Passe (l'arbre est
+													///< modifié en place).
+} Optpass;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Supprime le code mort et les instructions qui s'annulent.
+ * 
+ * Sont supprimés :
+ * - les boucles (et recherches) atteintes sur une case nulle : au début du
+ *   programme, où toute la bande est nulle (boucles de commentaire), ou juste
+ *   après une autre boucle, dont la case est nulle à la sortie ;
+ * - les incrémentations et décrémentations adjacentes d'une même case, et les
+ *   déplacements adjacents, qui sont fusionnés ("+-", "<>", ...).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param removedp L'emplacement qui reçoit le nombre de noeuds supprimés.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les noeuds supprimés sont
+ * libérés.
+ */
+extern Asttree optimize_dead(Asttree tree, int *removedp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Remplace les boucles idiomatiques d'un arbre par des noeuds dédiés.
+ * 
+ * Les boucles reconnues sont :
+ * - "[>]", "[<]", "[<>>]", ... : recherche d'une case nulle (A_SCAN) ;
+ * - les boucles affines : corps équilibré qui n'ajoute que des constantes à
+ *   des cases fixes, et dont le compteur change d'une constante impaire c
+ *   ("[-]", "[->+>++<<]", "[---->+<]", ...). Le nombre de tours, -x / c modulo
+ *   2^n (n étant la largeur des cases), est obtenu par l'inverse modulaire de
+ *   c : chaque case reçoit d'un coup sa modification totale (suite de A_MUL
+ *   suivie d'un A_CLEAR).
+ * 
+ * Les boucles imbriquées sont résumées de l'intérieur vers l'extérieur : une
+ * boucle interne dont le compteur est connu à chaque tour de la boucle externe
+ * (par exemple remis à zéro puis incrémenté) n'est qu'une suite d'additions
+ * constantes. Une boucle dont le compteur est connu à l'entrée (au début du
+ * programme, la bande est nulle) est entièrement évaluée.
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param replacedp L'emplacement qui reçoit le nombre de boucles remplacées.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les boucles remplacées sont
+ * libérées.
+ * @note Les facteurs obtenus dépendent de la largeur des cases choisie à la
+ * compilation.
+ */
+extern Asttree optimize_idioms(Asttree tree, int *replacedp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Réécrit les blocs de base d'un arbre en opérations adressées par
+ * décalage.
+ * 
+ * Dans chaque suite d'instructions simples, les déplacements sont supprimés :
+ * les incrémentations, décrémentations, lectures, écritures et remises à zéro
+ * reçoivent le décalage (champ 'id_symb') de leur case par rapport à un
+ * pointeur virtuel. Le pointeur réel n'est déplacé qu'une fois, avant chaque
+ * boucle, recherche ou multiplication, et à la fin du bloc (donc une seule
+ * fois par itération pour le corps d'une boucle).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les noeuds supprimés sont
+ * libérés.
+ */
+extern Asttree optimize_offsets(Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Déroule les boucles dont le nombre de tours est connu.
+ * 
+ * Une boucle est déroulée si son compteur est connu à l'entrée (remis à zéro
+ * puis initialisé, ou au début du programme) et si son corps, sans
+ * déplacement ni boucle interne, ne modifie son compteur que par des
+ * additions de constantes (d'une somme impaire). Si le nombre de tours n
+ * ne dépasse pas le facteur k, la boucle est remplacée par n copies de son
+ * corps ; sinon, n mod k copies précèdent une boucle dont le corps est
+ * répété k fois (un test de boucle pour k tours).
+ * 
+ * @param tree L'arbre à optimiser (adressé par décalage, voir
+ * optimize_offsets).
+ * @param factor Le facteur de déroulage (1 : aucun déroulage).
+ * @param fullp L'emplacement qui reçoit le nombre de boucles entièrement
+ * déroulées.
+ * @param partialp L'emplacement qui reçoit le nombre de boucles partiellement
+ * déroulées.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les boucles entièrement déroulées
+ * sont libérées.
+ */
+extern Asttree optimize_unroll(Asttree tree, int factor, int *fullp,
+							   int *partialp);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Applique à un arbre les passes d'optimisation du niveau choisi par
+ * FLAG_OPT_LEVEL, dans l'ordre (voir Optpass).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note Avec FLAG_STATS, la durée, le nombre de noeuds avant et après et le
+ * nombre de changements de chaque passe sont affichés sur la sortie
+ * d'erreur.
+ */
+extern Asttree optimize(Asttree tree);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
\ No newline at end of file
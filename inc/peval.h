@@ -0,0 +1,153 @@
+/**
+ * @file peval.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'évaluation partielle d'un programme Brainfuck :
+ * le préfixe qui précède la première lecture est exécuté à la compilation, et
+ * seul le reste du programme est conservé, avec l'état de la bande et la
+ * sortie obtenus.
+ * @date 2024-05-18
+ * 
+ * 
+ */
+#ifndef _PEVAL_H_
+#define _PEVAL_H_
+
+#include <inttypes.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def PEVAL_DEFAULT_BUDGET
+ * @brief Nombre de pas d'évaluation par défaut (chaque instruction et chaque
+ * test de boucle compte pour un pas).
+ * 
+ */
+#define PEVAL_DEFAULT_BUDGET 10000000L
+
+/**
+ * @def PEVAL_TAPE_SIZE
+ * @brief Nombre de cases de la bande d'évaluation (celui des programmes
+ * générés) : un accès au-delà arrête l'évaluation.
+ * 
+ */
+#define PEVAL_TAPE_SIZE 32000
+
+/**
+ * @def PEVAL_STOPS_STRINGS
+ * @brief Ensemble des chaînes de caractères associées à chaque cause d'arrêt
+ * de l'évaluation.
+ * 
+ * @note Les chaînes doivent OBLIGATOIREMENT être dans le même ordre que l'énu-
+ * mération PEVAL_STOPS.
+ */
+#define PEVAL_STOPS_STRINGS { \
+	"fin du programme", "lecture", "budget épuisé", "sortie de la bande" \
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 CONSTANTES                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @enum PEVAL_STOPS
+ * @brief Énumération des causes d'arrêt de l'évaluation partielle.
+ * 
+ */
+enum PEVAL_STOPS {
+	PEVAL_END,		///< Le programme a été entièrement évalué.
+	PEVAL_GET,		///< Une lecture ("," : A_GET) a été atteinte.
+	PEVAL_BUDGET,	///< Le nombre de pas a été épuisé.
+	PEVAL_BOUNDS	///< Le pointeur est sorti de la bande d'évaluation.
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Peval
+ * @struct Peval
+ * @brief Structure représentant le résultat de l'évaluation partielle d'un
+ * programme : le reste à exécuter et l'état dans lequel il commence.
+ * 
+ * @note L'évaluation s'arrête toujours entre deux instructions de premier
+ * niveau : une boucle interrompue est annulée et conservée dans le reste.
+ * @note 'rest' désigne un noeud de l'arbre d'origine (et ses petits-frères) :
+ * il ne doit pas être libéré séparément.
+ */
+typedef struct Peval {
+	Asttree rest;		///< Reste du programme (vide s'il est terminé).
+	uint32_t *tape;		///< Bande au début du reste.
+	long cells;			///< Cases significatives (les suivantes sont nulles).
+	long ptr;			///< Position du pointeur au début du reste.
+	uint32_t *output;	///< Valeurs écrites par le préfixe.
+	long length;		///< Nombre de valeurs écrites par le préfixe.
+	long steps;			///< Pas d'évaluation conservés.
+	int evaluated;		///< Instructions de premier niveau évaluées.
+	int stop;			///< Cause d'arrêt (PEVAL_STOPS).
+} Peval;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Évalue un programme jusqu'à sa première lecture, dans la limite
+ * d'un nombre de pas.
+ * 
+ * @param tree L'arbre (optimisé) du programme.
+ * @param budget Le nombre maximal de pas d'évaluation.
+ * @param bits La largeur des cases (8, 16 ou 32 bits).
+ * @return Peval Le reste du programme et son état initial.
+ */
+extern Peval peval(Asttree tree, long budget, int bits);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne true si l'évaluation partielle n'a rien évalué (le reste est
+ * alors le programme entier, sur une bande nulle).
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @return bool Vaut true si l'évaluation est sans effet.
+ */
+extern bool peval_is_empty(Peval pe);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit d'un bloc les valeurs écrites par le préfixe sur la sortie
+ * donnée (comme putchar, une valeur par octet).
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @param out La sortie.
+ */
+extern void peval_write(Peval pe, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le bilan de l'évaluation partielle sur la sortie donnée.
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @param out La sortie sur laquelle imprimer le bilan.
+ */
+extern void peval_print(Peval pe, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée au résultat d'une évaluation (mais pas le
+ * reste du programme).
+ * 
+ * @param pep Le pointeur vers le résultat à libérer.
+ */
+extern void peval_free(Peval *pep);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file scan.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la recherche vectorisée (SSE2/AVX2) d'une case
+ * nulle sur la bande de données, utilisée par les boucles de recherche
+ * ("[>]", "[<<]", "[>>>>]", ...).
+ * @date 2024-05-08
+ * 
+ * 
+ */
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+#include <stdint.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def SCAN_X86
+ * @brief Vaut 1 si les versions vectorisées de la recherche sont disponibles
+ * pour l'architecture cible (x86 / x86-64 avec GCC ou Clang), 0 sinon.
+ * 
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCAN_X86 1
+#else
+#define SCAN_X86 0
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Scanfn
+ * @brief Pointeur vers une fonction de recherche de case nulle.
+ * 
+ * @see scan_zero
+ */
+typedef void *(*Scanfn)(void *p, int step, int size);
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la première case nulle rencontrée en partant de la case
+ * donnée et en avançant par pas de 'step' cases de 'size' octets.
+ * 
+ * @param p La case de départ.
+ * @param step Le pas (signé) de la recherche.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case nulle rencontrée.
+ * 
+ * @note Le jeu d'instructions (AVX2, SSE2 ou scalaire) est choisi à la
+ * première utilisation, selon les capacités du processeur (cpuid).
+ * @note Les recherches dont l'écart en octets entre deux cases visitées
+ * divise la taille d'un vecteur (16 octets en SSE2, 32 en AVX2) sont
+ * vectorisées ; les autres utilisent la version scalaire.
+ */
+extern void *scan_zero(void *p, int step, int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nom du jeu d'instructions utilisé par la recherche de
+ * case nulle sur le processeur courant.
+ * 
+ * @return char* Le nom du jeu d'instructions.
+ */
+extern char *scan_isa();
+
+/* -------------------------------------------------------------------------- */
+
+#endif
\ No newline at end of file
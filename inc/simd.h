@@ -0,0 +1,80 @@
+/**
+ * @file simd.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'ajout vectorisé (SSE2/AVX2) d'un vecteur de
+ * constantes à des cases consécutives de la bande de données, utilisé par les
+ * blocs de base qui modifient de longues suites de cases (">+++>++>+++++").
+ * @date 2024-05-24
+ * 
+ * 
+ */
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include <stdint.h>
+
+#include "brainfuck.h"
+#include "scan.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Simdfn
+ * @brief Pointeur vers une fonction d'ajout d'un vecteur de constantes.
+ * 
+ * @see simd_add
+ */
+typedef void (*Simdfn)(void *p, const void *values, int length, int size);
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à chacune des 'length' cases consécutives qui commencent à la
+ * case donnée la constante correspondante (arithmétique modulaire).
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * 
+ * @note Le jeu d'instructions (AVX2, SSE2 ou scalaire) est choisi à la
+ * première utilisation, selon les capacités du processeur (cpuid), comme pour
+ * la recherche de case nulle (voir scan.h).
+ * @note Les accès ne sont pas alignés : seules les cases données sont lues et
+ * écrites, la fin de la suite étant traitée case par case.
+ */
+extern void simd_add(void *p, const void *values, int length, int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Affecte à chacune des 'length' cases consécutives qui commencent à
+ * la case donnée la constante correspondante.
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases, ou NULL pour
+ * remettre les cases à zéro.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * 
+ * @note memcpy et memset sont déjà vectorisés par la bibliothèque C.
+ */
+extern void simd_set(void *p, const void *values, int length, int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nom du jeu d'instructions utilisé par l'ajout vectorisé
+ * sur le processeur courant.
+ * 
+ * @return char* Le nom du jeu d'instructions.
+ */
+extern char *simd_isa();
+
+/* -------------------------------------------------------------------------- */
+
+#endif
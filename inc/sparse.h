@@ -0,0 +1,159 @@
+/**
+ * @file sparse.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la bande de données creuse de la machine
+ * virtuelle : une table à deux niveaux de pages de taille fixe, allouées au
+ * premier accès et indexées par une position signée sur 64 bits.
+ * @date 2024-05-16
+ * 
+ * 
+ */
+#ifndef _SPARSE_H_
+#define _SPARSE_H_
+
+#include <inttypes.h>
+
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def SPARSE_PAGE_BITS
+ * @brief Logarithme en base 2 du nombre de cases d'une page.
+ * 
+ */
+#define SPARSE_PAGE_BITS 12
+
+/**
+ * @def SPARSE_PAGE_CELLS
+ * @brief Nombre de cases d'une page.
+ * 
+ */
+#define SPARSE_PAGE_CELLS ((int64_t)1 << SPARSE_PAGE_BITS)
+
+/**
+ * @def SPARSE_LEAF_BITS
+ * @brief Logarithme en base 2 du nombre de pages d'une feuille (second niveau
+ * de la table).
+ * 
+ */
+#define SPARSE_LEAF_BITS 10
+
+/**
+ * @def SPARSE_LEAF_PAGES
+ * @brief Nombre de pages d'une feuille.
+ * 
+ */
+#define SPARSE_LEAF_PAGES ((int64_t)1 << SPARSE_LEAF_BITS)
+
+/**
+ * @def SPARSE_PAGE_BASE
+ * @brief Fonction macro donnant la position de la première case de la page
+ * qui contient la position donnée.
+ * 
+ */
+#define SPARSE_PAGE_BASE(pos) \
+	((int64_t)((uint64_t)(pos) & ~(uint64_t)(SPARSE_PAGE_CELLS - 1)))
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Sparseleaf
+ * @struct Sparseleaf
+ * @brief Structure représentant une entrée du répertoire (premier niveau de la
+ * table) : les pages d'une plage de SPARSE_LEAF_PAGES pages consécutives.
+ * 
+ */
+typedef struct Sparseleaf {
+	uint64_t key;		///< Numéro de la plage (bits de poids fort).
+	void **pages;		///< Pages de la plage (NULL : entrée libre).
+} Sparseleaf;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Sparsetape
+ * @struct Sparsetape
+ * @brief Structure représentant une bande de données creuse.
+ * 
+ * @note Le répertoire est une table de hachage à adressage ouvert, dont la
+ * capacité est une puissance de 2 : seules les plages effectivement touchées
+ * y figurent, quelle que soit l'étendue de la bande.
+ */
+typedef struct Sparsetape {
+	Sparseleaf *dir;	///< Répertoire des plages.
+	size_t capacity;	///< Capacité du répertoire.
+	size_t leaves;		///< Nombre de plages allouées.
+	Sparseleaf *last;	///< Dernière plage consultée.
+	int size;			///< Taille d'une case (1, 2 ou 4 octets).
+	long pages;			///< Nombre de pages allouées.
+	int64_t low;		///< Plus petite position de page allouée.
+	int64_t high;		///< Plus grande position de page allouée.
+} Sparsetape;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialise une bande de données creuse vide.
+ * 
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return Sparsetape La bande initialisée.
+ */
+extern Sparsetape sparse_init(int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la première case de la page qui contient la position donnée,
+ * en allouant (à zéro) la page si elle n'a jamais été touchée.
+ * 
+ * @param tapep Le pointeur vers la bande.
+ * @param pos La position (signée) d'une case.
+ * @return void* La première case de la page.
+ * 
+ * @note Un échec d'allocation provoquera une erreur.
+ */
+extern void *sparse_page(Sparsetape *tapep, int64_t pos);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la case située à la position donnée.
+ * 
+ * @param tapep Le pointeur vers la bande.
+ * @param pos La position (signée) de la case.
+ * @return void* La case.
+ * 
+ * @see sparse_page
+ */
+extern void *sparse_cell(Sparsetape *tapep, int64_t pos);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime l'occupation de la bande (pages allouées et étendue touchée)
+ * sur la sortie donnée.
+ * 
+ * @param tape La bande.
+ * @param out La sortie sur laquelle imprimer l'occupation.
+ */
+extern void sparse_print(Sparsetape tape, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à la bande.
+ * 
+ * @param tapep Le pointeur vers la bande à libérer.
+ */
+extern void sparse_free(Sparsetape *tapep);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
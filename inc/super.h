@@ -0,0 +1,154 @@
+/**
+ * @file super.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant le choix des superinstructions d'un programme
+ * linéaire à partir d'un profil d'exécution : fréquences des paires et des
+ * triplets d'instructions consécutives, enregistrées dans un fichier.
+ * @date 2024-05-17
+ * 
+ * 
+ */
+#ifndef _SUPER_H_
+#define _SUPER_H_
+
+#include "brainfuck.h"
+#include "flat.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def SUPER_MAX_SELECTED
+ * @brief Nombre maximal de superinstructions retenues à partir d'un profil.
+ * 
+ */
+#define SUPER_MAX_SELECTED 8
+
+/**
+ * @def SUPER_PROFILE_HEADER
+ * @brief Première ligne d'un fichier de profil.
+ * 
+ */
+#define SUPER_PROFILE_HEADER "# brainfuck : profil des superinstructions"
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Superprofile
+ * @struct Superprofile
+ * @brief Structure représentant un profil d'exécution : pour chaque suite de
+ * deux ou trois instructions de base consécutives, le nombre de fois où elle
+ * a été exécutée d'un seul tenant.
+ * 
+ * @note Les compteurs s'accumulent d'une exécution à l'autre (par exemple sur
+ * tout un corpus de programmes) dans le même fichier.
+ */
+typedef struct Superprofile {
+	long runs;			///< Exécutions enregistrées.
+	long total;			///< Instructions distribuées.
+	long pairs[FLAT_BASE_OPS][FLAT_BASE_OPS];
+	long triples[FLAT_BASE_OPS][FLAT_BASE_OPS][FLAT_BASE_OPS];
+} Superprofile;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Superset
+ * @struct Superset
+ * @brief Structure représentant les superinstructions retenues, par gain
+ * (distributions évitées dans le profil) décroissant.
+ * 
+ */
+typedef struct Superset {
+	int ops[SUPER_MAX_SELECTED];	///< Codes d'opérations retenus.
+	long gains[SUPER_MAX_SELECTED];	///< Distributions évitées (profil).
+	int length;						///< Nombre de superinstructions retenues.
+} Superset;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Charge un profil depuis le fichier donné.
+ * 
+ * @param profilep Le pointeur vers le profil à remplir.
+ * @param path Le chemin du fichier.
+ * @param required Vaut true si l'absence du fichier est une erreur ; sinon,
+ * le profil est simplement vide.
+ * 
+ * @note Une ligne mal formée provoquera une erreur.
+ */
+extern void super_load(Superprofile *profilep, char *path, bool required);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit un profil dans le fichier donné.
+ * 
+ * @param profilep Le pointeur vers le profil à écrire.
+ * @param path Le chemin du fichier.
+ */
+extern void super_save(Superprofile *profilep, char *path);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à un profil les suites exécutées par un programme, à partir
+ * du nombre d'exécutions de chacune de ses instructions.
+ * 
+ * @param profilep Le pointeur vers le profil.
+ * @param prog Le programme exécuté (sans superinstructions).
+ * @param exec Le nombre d'exécutions de chaque instruction.
+ */
+extern void super_record(Superprofile *profilep, Flatprog prog, long *exec);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retient, d'après le profil, les superinstructions qui évitent le
+ * plus de distributions.
+ * 
+ * @param profilep Le pointeur vers le profil.
+ * @return Superset Les superinstructions retenues.
+ * 
+ * @note Seules les suites qui disposent d'un gestionnaire dans la machine
+ * virtuelle (voir FLAT_SUPER_PAIRS et FLAT_SUPER_TRIPLES) sont candidates.
+ */
+extern Superset super_select(Superprofile *profilep);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Remplace dans un programme les suites retenues par leurs
+ * superinstructions.
+ * 
+ * @param progp Le pointeur vers le programme.
+ * @param set Les superinstructions retenues.
+ * @return int Le nombre de suites remplacées.
+ * 
+ * @note Le programme est parcouru une seule fois, de gauche à droite ; à
+ * chaque instruction, la première superinstruction (par gain) qui convient
+ * est utilisée.
+ */
+extern int super_fuse(Flatprog *progp, Superset set);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime, pour un programme exécuté, le nombre de distributions avant
+ * fusion puis après chaque fusion retenue.
+ * 
+ * @param prog Le programme exécuté (sans superinstructions).
+ * @param exec Le nombre d'exécutions de chaque instruction.
+ * @param set Les superinstructions retenues.
+ * @param out La sortie sur laquelle imprimer le rapport.
+ */
+extern void super_report(Flatprog prog, long *exec, Superset set, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file tape.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la bande de données de la machine virtuelle :
+ * une zone virtuelle réservée (mmap) dont la partie engagée est entourée de
+ * pages de garde, agrandie à la demande par un gestionnaire de SIGSEGV.
+ * @date 2024-05-15
+ * 
+ * 
+ */
+#ifndef _TAPE_H_
+#define _TAPE_H_
+
+#include <stdint.h>
+#include "brainfuck.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def TAPE_GUARDED
+ * @brief Vaut 1 si la bande est protégée par des pages de garde (système
+ * POSIX), 0 si elle est simplement allouée par calloc.
+ * 
+ */
+#if defined(__unix__)
+#define TAPE_GUARDED 1
+#else
+#define TAPE_GUARDED 0
+#endif
+
+/**
+ * @def TAPE_RESERVE_SIZE
+ * @brief Taille (en octets) de la zone virtuelle réservée à droite de la
+ * première case : la bande ne peut pas être agrandie au-delà.
+ * 
+ */
+#define TAPE_RESERVE_SIZE ((size_t)1 << 30)
+
+/**
+ * @def TAPE_GUARD_SIZE
+ * @brief Taille (en octets) de chacune des zones de garde situées avant la
+ * première case et après la réserve. Sur 64 bits, elle dépasse la portée d'un
+ * déplacement suivi d'un accès décalé (2 * 2^31 cases de 4 octets), qui ne
+ * peut donc pas sortir de la zone réservée depuis la bande.
+ * 
+ */
+#if SIZE_MAX > 0xFFFFFFFFu
+#define TAPE_GUARD_SIZE ((size_t)1 << 34)
+#else
+#define TAPE_GUARD_SIZE ((size_t)1 << 16)
+#endif
+
+/**
+ * @def TAPE_OUT_OF_BOUNDS
+ * @brief Code de reprise (tape_escape) d'un accès hors de la bande.
+ * 
+ */
+#define TAPE_OUT_OF_BOUNDS 1
+
+/**
+ * @def TAPE_GROW_FAILED
+ * @brief Code de reprise (tape_escape) d'un échec d'agrandissement de la
+ * bande.
+ * 
+ */
+#define TAPE_GROW_FAILED 2
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Alloue une bande de données initialisée à zéro.
+ * 
+ * @param cells Le nombre de cases initialement engagées.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case de la bande.
+ * 
+ * @note Un échec d'allocation provoquera une erreur.
+ * @note Une seule bande peut être allouée à la fois.
+ */
+extern void *tape_init(size_t cells, int size);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime l'état de la bande de données (cases engagées et
+ * agrandissements) sur la sortie donnée.
+ * 
+ * @param out La sortie sur laquelle imprimer l'état.
+ */
+extern void tape_print(FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Signale l'erreur ayant interrompu l'exécution sur la bande de données
+ * (code rendu par sigsetjmp(tape_escape, 1)).
+ * 
+ * @param code Le code de l'erreur (TAPE_OUT_OF_BOUNDS ou TAPE_GROW_FAILED).
+ * 
+ * @note Cette fonction provoquera une erreur.
+ */
+extern void tape_report(int code);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la bande de données et rétablit le traitement par défaut de
+ * SIGSEGV.
+ * 
+ */
+extern void tape_free();
+
+/* -------------------------------------------------------------------------- */
+
+#endif
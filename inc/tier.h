@@ -0,0 +1,145 @@
+/**
+ * @file tier.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'exécution par niveaux : les boucles d'un
+ * programme linéaire sont d'abord interprétées, puis compilées à la volée
+ * (JIT) lorsque leur nombre de retours arrière dépasse un seuil.
+ * @date 2024-05-13
+ * 
+ * 
+ */
+#ifndef _TIER_H_
+#define _TIER_H_
+
+#include "brainfuck.h"
+#include "flat.h"
+#include "jit.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def TIER_DEFAULT_THRESHOLD
+ * @brief Nombre de retours arrière par défaut au-delà duquel une boucle est
+ * compilée en code machine.
+ * 
+ */
+#define TIER_DEFAULT_THRESHOLD 1000
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Tierloop
+ * @struct Tierloop
+ * @brief Structure représentant l'état d'une boucle d'un programme linéaire.
+ * 
+ */
+typedef struct Tierloop {
+	long backedges;		///< Retours arrière interprétés.
+	Jitcode code;		///< Code machine de la boucle (vide si non compilée).
+} Tierloop;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Tierstats
+ * @struct Tierstats
+ * @brief Structure regroupant les compteurs d'exécution de chaque niveau.
+ * 
+ * @note Le niveau 0 est l'interprétation du programme linéaire, le niveau 1
+ * l'exécution du code machine des boucles compilées.
+ */
+typedef struct Tierstats {
+	long interpreted;	///< Retours arrière interprétés (niveau 0).
+	int compiled;		///< Boucles compilées.
+	long entries;		///< Entrées dans le code machine (niveau 1).
+	long native;		///< Itérations exécutées en code machine (niveau 1).
+} Tierstats;
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Tier
+ * @struct Tier
+ * @brief Structure représentant l'état de l'exécution par niveaux d'un
+ * programme linéaire.
+ * 
+ * @note Le tableau 'loops' est indexé par l'indice de l'instruction F_JZ de
+ * chaque boucle ; les autres entrées sont inutilisées.
+ */
+typedef struct Tier {
+	Flatprog *progp;	///< Programme linéaire exécuté.
+	Tierloop *loops;	///< État des boucles du programme.
+	long threshold;		///< Seuil de compilation (en retours arrière).
+	int size;			///< Taille d'une case (1, 2 ou 4 octets).
+	bool count;			///< Comptage des itérations du code machine.
+	Tierstats stats;	///< Compteurs d'exécution.
+} Tier;
+
+/* -------------------------------------------------------------------------- */
+/*                          PROTOTYPES DES FONCTIONS                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialise l'exécution par niveaux d'un programme linéaire.
+ * 
+ * @param progp Le pointeur vers le programme à exécuter.
+ * @param threshold Le seuil de compilation (en retours arrière).
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @param count Vaut true si les itérations du code machine sont comptées.
+ * @return Tier L'état initial de l'exécution par niveaux.
+ */
+extern Tier tier_init(Flatprog *progp, long threshold, int size, bool count);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Enregistre un retour arrière de la boucle donnée et la compile si
+ * elle atteint le seuil.
+ * 
+ * @param tierp Le pointeur vers l'état de l'exécution par niveaux.
+ * @param head L'indice de l'instruction F_JZ de la boucle.
+ * @return bool Vaut true si la boucle dispose d'un code machine.
+ */
+extern bool tier_backedge(Tier *tierp, int head);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute le code machine de la boucle donnée à partir de la case
+ * pointée, au début d'une itération.
+ * 
+ * @param tierp Le pointeur vers l'état de l'exécution par niveaux.
+ * @param head L'indice de l'instruction F_JZ de la boucle (compilée).
+ * @param ptr La case pointée.
+ * @return void* La case pointée à la sortie de la boucle.
+ */
+extern void *tier_run(Tier *tierp, int head, void *ptr);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime les compteurs d'exécution de chaque niveau sur la sortie
+ * donnée.
+ * 
+ * @param tier L'état de l'exécution par niveaux.
+ * @param out La sortie sur laquelle imprimer les compteurs.
+ */
+extern void tier_print(Tier tier, FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à l'exécution par niveaux (dont le code
+ * machine des boucles compilées).
+ * 
+ * @param tierp Le pointeur vers l'état à libérer.
+ */
+extern void tier_free(Tier *tierp);
+
+/* -------------------------------------------------------------------------- */
+
+#endif
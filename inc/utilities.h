@@ -48,6 +48,18 @@ extern void print_simple_inst(FILE *out, char *inst, int count, int depth);
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Imprime une instruction formatée, précédée de son indentation.
+ * 
+ * @param out Le fichier de sortie.
+ * @param depth La profondeur (indentation) de l'instruction.
+ * @param format Le format de l'instruction.
+ * @param ... Les arguments à placer dans le format de l'instruction.
+ */
+extern void print_inst(FILE *out, int depth, char *format, ...);
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * @brief Affiche la notice d'utilisation du programme.
  * 
@@ -56,6 +68,7 @@ extern void print_simple_inst(FILE *out, char *inst, int count, int depth);
  * @param ... Les arguments à placer dans le format du message.
  * 
  * @see HELP_NOTICE_FORMAT
+ * @see HELP_NOTICE_OPTIONS
  */
 extern void usage(char *program, char *format, ...);
 
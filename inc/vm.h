@@ -11,6 +11,17 @@
 #define _VM_H_
 
 #include "brainfuck.h"
+#include "flat.h"
+#include "block.h"
+#include "scan.h"
+#include "simd.h"
+#include "jit.h"
+#include "tier.h"
+#include "tape.h"
+#include "sparse.h"
+#include "super.h"
+#include "peval.h"
+#include "bounds.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                CONSTANTES                                  */
@@ -18,11 +29,27 @@
 
 /**
  * @def DATA_STACK_SIZE
- * @brief Taille de la pile de données.
+ * @brief Taille initiale (en cases) de la pile de données, lorsque les
+ * positions atteintes par le programme ne sont pas bornées (voir bounds.h).
  * 
  */
 #define DATA_STACK_SIZE 32000
 
+/**
+ * @def VM_THREADED_DISPATCH
+ * @brief Vaut 1 si la machine virtuelle est compilée avec une distribution
+ * directe des instructions ('direct threading', via les étiquettes-valeurs
+ * de GCC : '&&label' et 'goto *'), 0 si elle utilise un 'switch'.
+ * 
+ * @note Définir VM_PORTABLE à la compilation (make PORTABLE=1) force la
+ * distribution par 'switch', conforme au C standard.
+ */
+#if defined(__GNUC__) && !defined(VM_PORTABLE)
+#define VM_THREADED_DISPATCH 1
+#else
+#define VM_THREADED_DISPATCH 0
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*                          PROTOTYPES DES FONCTIONS                          */
 /* -------------------------------------------------------------------------- */
@@ -37,4 +64,26 @@ extern void execute_program(Asttree tree);
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Retourne le nom du mode de distribution des instructions avec lequel
+ * la machine virtuelle a été compilée.
+ * 
+ * @return char* Le nom du mode de distribution.
+ * 
+ * @see VM_THREADED_DISPATCH
+ */
+extern char *vm_dispatch_mode();
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime la configuration de compilation de la machine virtuelle sur
+ * la sortie donnée.
+ * 
+ * @param out La sortie sur laquelle imprimer la configuration.
+ */
+extern void vm_info(FILE *out);
+
+/* -------------------------------------------------------------------------- */
+
 #endif
\ No newline at end of file
@@ -0,0 +1,597 @@
+/**
+ * @file vm_engine.h
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Gabarit des moteurs d'exécution de la machine virtuelle, instancié
+ * une fois par largeur de case.
+ * @date 2024-05-14
+ * 
+ * Avant chaque inclusion, il faut définir :
+ * - VM_CELL   : le type (non signé) d'une case de la bande de données ;
+ * - VM_SUFFIX : le suffixe des noms des fonctions de l'instance.
+ * 
+ * Ces deux macros sont retirées à la fin du fichier. Les macros VM_BEGIN,
+ * VM_OP, VM_NEXT et VM_END de distribution des instructions doivent être
+ * définies par le fichier qui inclut le gabarit.
+ * 
+ * @note Ce fichier n'a volontairement pas de garde d'inclusion.
+ */
+#if !defined(VM_CELL) || !defined(VM_SUFFIX)
+#error "vm_engine.h : VM_CELL et VM_SUFFIX doivent être définies."
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def VM_NAME
+ * @brief Fonction macro suffixant un nom par la largeur de l'instance
+ * (VM_NAME(ptr) donne 'ptr_8' pour des cases de 8 bits).
+ * 
+ */
+#define VM_NAME(name) VM_CONCAT(name, VM_SUFFIX)
+#define VM_CONCAT(name, suffix) VM_CONCAT_(name, suffix)
+#define VM_CONCAT_(name, suffix) name##_##suffix
+
+/*
+ * Corps des instructions du programme linéaire, partagés par les
+ * gestionnaires des instructions de base et des superinstructions
+ * (execute_flat, variables locales 'ptr', 'pc', 'code' et 'tierp').
+ * 
+ * 'ip' désigne l'instruction exécutée ; pour un saut, elle doit être 'pc'.
+ */
+#define VM_DO_ADD(ip)	ptr[(ip)->offset] += (ip)->arg
+#define VM_DO_MOVE(ip)	ptr += (ip)->arg
+#define VM_DO_CLEAR(ip)	ptr[(ip)->offset] = (ip)->arg
+#define VM_DO_MUL(ip)	ptr[(*ptr != 0) ? (ip)->offset : 0] += (*ptr) * (ip)->arg
+#define VM_DO_VADD(ip) \
+	simd_add(ptr + (ip)->offset, VM_NAME(vectors)[(ip)->arg].values, \
+			 VM_NAME(vectors)[(ip)->arg].length, sizeof(VM_CELL))
+#define VM_DO_VSET(ip) \
+	simd_set(ptr + (ip)->offset, VM_NAME(vectors)[(ip)->arg].values, \
+			 VM_NAME(vectors)[(ip)->arg].length, sizeof(VM_CELL))
+#define VM_DO_JZ(ip) \
+	if (*ptr == 0) { \
+		pc = code + (ip)->arg; \
+	} else if (tierp != NULL && tierp->loops[(ip) - code].code.code != NULL) { \
+		ptr = tier_run(tierp, (ip) - code, ptr); \
+		pc = code + (ip)->arg; \
+	}
+#define VM_DO_JNZ(ip) \
+	if (*ptr != 0) { \
+		pc = code + (ip)->arg; \
+		if (tierp != NULL && tier_backedge(tierp, pc - code)) { \
+			ptr = tier_run(tierp, pc - code, ptr); \
+			pc = code + pc->arg; \
+		} \
+	}
+
+/*
+ * Gestionnaires et étiquettes des superinstructions (voir FLAT_SUPER_PAIRS) :
+ * les premières instructions sont exécutées à partir de 'pc', puis 'pc'
+ * avance jusqu'à la dernière, qui peut être un saut.
+ */
+#define VM_PAIR_LABEL(a, b) &&L_F_##a##_##b,
+#define VM_TRIPLE_LABEL(a, b, c) &&L_F_##a##_##b##_##c,
+#define VM_PAIR_HANDLER(a, b) \
+	VM_OP(F_##a##_##b): \
+		VM_DO_##a(pc); \
+		pc += 1; \
+		VM_DO_##b(pc); \
+		VM_NEXT();
+#define VM_TRIPLE_HANDLER(a, b, c) \
+	VM_OP(F_##a##_##b##_##c): \
+		VM_DO_##a(pc); \
+		VM_DO_##b(pc + 1); \
+		pc += 2; \
+		VM_DO_##c(pc); \
+		VM_NEXT();
+
+/**
+ * @def VM_SPARSE_AT
+ * @brief Fonction macro donnant la case située à 'off' cases de la case
+ * pointée sur une bande creuse : accès direct si elle se trouve dans la page
+ * courante, consultation de la table sinon.
+ * 
+ * @note Utilisée uniquement par execute_sparse (variables locales 'pos',
+ * 'base', 'cell' et 'tapep').
+ */
+#define VM_SPARSE_AT(off) \
+	((uint64_t)(pos - base + (off)) < (uint64_t)SPARSE_PAGE_CELLS \
+		? cell + (off) : (VM_CELL *)sparse_cell(tapep, pos + (off)))
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @var VM_CELL * VM_NAME(ptr)
+ * @brief Pointeur de données de l'instance.
+ * 
+ */
+static VM_CELL *VM_NAME(ptr);
+
+/**
+ * @var Flatvec * VM_NAME(vectors)
+ * @brief Vecteurs de constantes (F_VADD, F_VSET) du programme linéaire
+ * exécuté par l'instance.
+ * 
+ */
+static Flatvec *VM_NAME(vectors);
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute une instruction Brainfuck représentée sous la forme d'un
+ * arbre de syntaxe abstraite (AST).
+ * 
+ * @param tree L'arbre de syntaxe abstraite (AST) de l'instruction.
+ * 
+ * @note Cette fonction exécute en chaîne toutes les instructions qui suivent
+ * l'instruction donnée.
+ */
+static void VM_NAME(execute_instruction)(Asttree tree) {
+	VM_CELL *ptr = VM_NAME(ptr);
+	int ast_type, count, offset;
+
+	if (ast_is_empty(tree)) return;
+
+	// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
+	// d'opérations simples successives, et le champ 'numéro de symbole' le
+	// décalage de la case visée.
+	count = tree->id_lex;
+	offset = tree->id_symb;
+
+	ast_type = tree->type;
+	switch (ast_type) {
+		case A_LOOP:
+			while (*VM_NAME(ptr) != 0)
+				VM_NAME(execute_instruction)(tree->son);
+			break;
+		case A_INC:
+			ptr[offset] += count;
+			break;
+		case A_DEC:
+			ptr[offset] -= count;
+			break;
+		case A_LEFT:
+			VM_NAME(ptr) -= count;
+			break;
+		case A_RIGHT:
+			VM_NAME(ptr) += count;
+			break;
+		case A_PUT:
+			for (int i = 0;  i < count; i++)
+				putchar(ptr[offset]);
+			break;
+		case A_GET:
+			for (int i = 0; i < count; i++)
+				ptr[offset] = getchar();
+
+			EMPTY_BUFFER();
+			break;
+		case A_CLEAR:
+			ptr[offset] = 0;
+			break;
+		case A_SCAN:
+			VM_NAME(ptr) = scan_zero(ptr, count, sizeof(VM_CELL));
+			break;
+		case A_MUL:
+			// Comme la boucle d'origine, ne touche aucune autre case si *ptr
+			// est nul (elle pourrait être hors de la bande) : la case pointée
+			// reçoit alors 0, sans branchement.
+			ptr[(*ptr != 0) ? offset : 0] += (*ptr) * count;
+			break;
+		default:
+			merror("execute_instruction() : 'tree->type' inconnu !");
+	}
+
+	VM_NAME(execute_instruction)(tree->little_brother);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un programme Brainfuck représenté sous forme linéaire.
+ * 
+ * @param code Les instructions du programme, terminées par F_END.
+ * @param tierp Le pointeur vers l'état de l'exécution par niveaux, ou NULL
+ * pour une exécution entièrement interprétée.
+ * 
+ * @note Contrairement à execute_instruction, cette fonction n'est pas
+ * récursive : les boucles sont résolues par les indices de saut précalculés.
+ * @note Le mode de distribution dépend de VM_THREADED_DISPATCH.
+ * @note Les superinstructions (voir super.h) ont chacune leur gestionnaire.
+ * @note En exécution par niveaux, une boucle compilée est exécutée en code
+ * machine dès son entrée, ou dès son retour arrière si elle vient d'atteindre
+ * le seuil ; l'exécution reprend ensuite après la boucle.
+ */
+static void VM_NAME(execute_flat)(Flatinst *code, Tier *tierp) {
+	VM_CELL *ptr = VM_NAME(ptr);
+	Flatinst *pc = code;
+
+#if VM_THREADED_DISPATCH
+	// Doit suivre l'ordre de l'énumération FLAT_OPS.
+	static void *handlers[] = {
+		&&L_F_ADD, &&L_F_MOVE, &&L_F_PUT, &&L_F_GET,
+		&&L_F_JZ, &&L_F_JNZ, &&L_F_END, &&L_F_CLEAR, &&L_F_SCAN,
+		&&L_F_MUL, &&L_F_VADD, &&L_F_VSET,
+		FLAT_SUPER_PAIRS(VM_PAIR_LABEL)
+		FLAT_SUPER_TRIPLES(VM_TRIPLE_LABEL)
+	};
+#endif
+
+	VM_BEGIN()
+		VM_OP(F_ADD):
+			VM_DO_ADD(pc);
+			VM_NEXT();
+		VM_OP(F_MOVE):
+			VM_DO_MOVE(pc);
+			VM_NEXT();
+		VM_OP(F_PUT):
+			for (int i = 0; i < pc->arg; i++)
+				putchar(ptr[pc->offset]);
+			VM_NEXT();
+		VM_OP(F_GET):
+			for (int i = 0; i < pc->arg; i++)
+				ptr[pc->offset] = getchar();
+
+			EMPTY_BUFFER();
+			VM_NEXT();
+		VM_OP(F_JZ):
+			VM_DO_JZ(pc);
+			VM_NEXT();
+		VM_OP(F_JNZ):
+			VM_DO_JNZ(pc);
+			VM_NEXT();
+		VM_OP(F_CLEAR):
+			VM_DO_CLEAR(pc);
+			VM_NEXT();
+		VM_OP(F_SCAN):
+			ptr = scan_zero(ptr, pc->arg, sizeof(VM_CELL));
+			VM_NEXT();
+		VM_OP(F_MUL):
+			VM_DO_MUL(pc);
+			VM_NEXT();
+		VM_OP(F_VADD):
+			VM_DO_VADD(pc);
+			VM_NEXT();
+		VM_OP(F_VSET):
+			VM_DO_VSET(pc);
+			VM_NEXT();
+		FLAT_SUPER_PAIRS(VM_PAIR_HANDLER)
+		FLAT_SUPER_TRIPLES(VM_TRIPLE_HANDLER)
+		VM_OP(F_END):
+			VM_NAME(ptr) = ptr;
+			return;
+	VM_END()
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un programme linéaire (sans superinstructions) en comptant
+ * les exécutions de chacune de ses instructions.
+ * 
+ * @param code Les instructions du programme, terminées par F_END.
+ * @param exec Le nombre d'exécutions de chaque instruction (à zéro).
+ * 
+ * @note Ce moteur, simple et lent, ne sert qu'à l'enregistrement d'un profil
+ * (voir super.h).
+ */
+static void VM_NAME(execute_count)(Flatinst *code, long *exec) {
+	VM_CELL *ptr = VM_NAME(ptr);
+
+	for (Flatinst *pc = code;; pc++) {
+		exec[pc - code]++;
+
+		switch (pc->op) {
+			case F_ADD:
+				ptr[pc->offset] += pc->arg;
+				break;
+			case F_MOVE:
+				ptr += pc->arg;
+				break;
+			case F_PUT:
+				for (int i = 0; i < pc->arg; i++)
+					putchar(ptr[pc->offset]);
+				break;
+			case F_GET:
+				for (int i = 0; i < pc->arg; i++)
+					ptr[pc->offset] = getchar();
+
+				EMPTY_BUFFER();
+				break;
+			case F_JZ:
+				if (*ptr == 0) pc = code + pc->arg;
+				break;
+			case F_JNZ:
+				if (*ptr != 0) pc = code + pc->arg;
+				break;
+			case F_CLEAR:
+				ptr[pc->offset] = pc->arg;
+				break;
+			case F_SCAN:
+				ptr = scan_zero(ptr, pc->arg, sizeof(VM_CELL));
+				break;
+			case F_MUL:
+				ptr[(*ptr != 0) ? pc->offset : 0] += (*ptr) * pc->arg;
+				break;
+			case F_VADD:
+				VM_DO_VADD(pc);
+				break;
+			case F_VSET:
+				VM_DO_VSET(pc);
+				break;
+			case F_END:
+				VM_NAME(ptr) = ptr;
+				return;
+			default:
+				merror("execute_count() : 'pc->op' inconnu !");
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute une boucle dans les bornes d'un programme linéaire (sans
+ * superinstructions), sans aucun test de position.
+ * 
+ * @param code Les instructions du programme.
+ * @param open L'instruction F_JZ de la boucle.
+ * @param ptr La case pointée à l'entrée de la boucle.
+ * 
+ * @note Toutes les cases accédées par la boucle doivent être contiguës à la
+ * case pointée (voir bounds.h) : la boucle ne contient aucun F_SCAN et rend
+ * le pointeur à sa position d'entrée.
+ */
+static void VM_NAME(execute_bounded)(Flatinst *code, Flatinst *open,
+									 VM_CELL *ptr) {
+	Flatinst *close = code + open->arg;
+
+	for (Flatinst *pc = open + 1;; pc++) {
+		switch (pc->op) {
+			case F_ADD:
+				ptr[pc->offset] += pc->arg;
+				break;
+			case F_MOVE:
+				ptr += pc->arg;
+				break;
+			case F_PUT:
+				for (int i = 0; i < pc->arg; i++)
+					putchar(ptr[pc->offset]);
+				break;
+			case F_GET:
+				for (int i = 0; i < pc->arg; i++)
+					ptr[pc->offset] = getchar();
+
+				EMPTY_BUFFER();
+				break;
+			case F_JZ:
+				if (*ptr == 0) pc = code + pc->arg;
+				break;
+			case F_JNZ:
+				if (*ptr != 0) pc = code + pc->arg;
+				else if (pc == close) return;
+				break;
+			case F_CLEAR:
+				ptr[pc->offset] = pc->arg;
+				break;
+			case F_MUL:
+				ptr[(*ptr != 0) ? pc->offset : 0] += (*ptr) * pc->arg;
+				break;
+			case F_VADD:
+				VM_DO_VADD(pc);
+				break;
+			case F_VSET:
+				VM_DO_VSET(pc);
+				break;
+			default:
+				merror("execute_bounded() : 'pc->op' inconnu !");
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un programme Brainfuck représenté sous forme linéaire sur une
+ * bande de données creuse.
+ * 
+ * @param code Les instructions du programme, terminées par F_END.
+ * @param tapep Le pointeur vers la bande creuse.
+ * @param start La position initiale du pointeur de données.
+ * 
+ * @note La case pointée est repérée par sa position signée 'pos' ; la page
+ * courante ('base' et 'cell') suit le pointeur de données, de sorte que
+ * seules les instructions qui sortent de la page consultent la table.
+ * @note Une boucle dans les bornes (voir bounds.h) dont toutes les cases sont
+ * dans la page courante est exécutée par execute_bounded, sans test.
+ */
+static void VM_NAME(execute_sparse)(Flatinst *code, Sparsetape *tapep,
+									int64_t start) {
+	int64_t pos = start, base = SPARSE_PAGE_BASE(start);
+	VM_CELL *cell = sparse_cell(tapep, start), value;
+	Flatinst *pc = code;
+	Flatvec *vector;
+
+#if VM_THREADED_DISPATCH
+	// Doit suivre l'ordre de l'énumération FLAT_OPS.
+	static void *handlers[] = {
+		&&L_F_ADD, &&L_F_MOVE, &&L_F_PUT, &&L_F_GET,
+		&&L_F_JZ, &&L_F_JNZ, &&L_F_END, &&L_F_CLEAR, &&L_F_SCAN,
+		&&L_F_MUL, &&L_F_VADD, &&L_F_VSET
+	};
+#endif
+
+	VM_BEGIN()
+		VM_OP(F_ADD):
+			*VM_SPARSE_AT(pc->offset) += pc->arg;
+			VM_NEXT();
+		VM_OP(F_MOVE):
+			cell = VM_SPARSE_AT(pc->arg);
+			pos += pc->arg;
+			if ((uint64_t)(pos - base) >= (uint64_t)SPARSE_PAGE_CELLS)
+				base = SPARSE_PAGE_BASE(pos);
+			VM_NEXT();
+		VM_OP(F_PUT):
+			for (int i = 0; i < pc->arg; i++)
+				putchar(*VM_SPARSE_AT(pc->offset));
+			VM_NEXT();
+		VM_OP(F_GET):
+			for (int i = 0; i < pc->arg; i++)
+				*VM_SPARSE_AT(pc->offset) = getchar();
+
+			EMPTY_BUFFER();
+			VM_NEXT();
+		VM_OP(F_JZ):
+			if (*cell == 0) {
+				pc = code + pc->arg;
+			} else if (BOUNDS_IS_KNOWN(pc->offset, code[pc->arg].offset)
+					   && (uint64_t)(pos - base + pc->offset)
+						  < (uint64_t)SPARSE_PAGE_CELLS
+					   && (uint64_t)(pos - base + code[pc->arg].offset)
+						  < (uint64_t)SPARSE_PAGE_CELLS) {
+				// Boucle entière dans la page courante : aucun test par accès.
+				VM_NAME(execute_bounded)(code, pc, cell);
+				pc = code + pc->arg;
+			}
+			VM_NEXT();
+		VM_OP(F_JNZ):
+			if (*cell != 0) pc = code + pc->arg;
+			VM_NEXT();
+		VM_OP(F_CLEAR):
+			*VM_SPARSE_AT(pc->offset) = pc->arg;
+			VM_NEXT();
+		VM_OP(F_SCAN):
+			while (*cell != 0) {
+				cell = VM_SPARSE_AT(pc->arg);
+				pos += pc->arg;
+				if ((uint64_t)(pos - base) >= (uint64_t)SPARSE_PAGE_CELLS)
+					base = SPARSE_PAGE_BASE(pos);
+			}
+			VM_NEXT();
+		VM_OP(F_MUL):
+			// Une case nulle ne touche aucune autre case (ni aucune page).
+			if (*cell != 0) *VM_SPARSE_AT(pc->offset) += (*cell) * pc->arg;
+			VM_NEXT();
+		VM_OP(F_VADD):
+		VM_OP(F_VSET):
+			vector = &VM_NAME(vectors)[pc->arg];
+			if ((uint64_t)(pos - base + pc->offset)
+				< (uint64_t)SPARSE_PAGE_CELLS
+				&& (uint64_t)(pos - base + pc->offset + vector->length - 1)
+				   < (uint64_t)SPARSE_PAGE_CELLS) {
+				// Vecteur entier dans la page courante.
+				if (pc->op == F_VADD)
+					simd_add(cell + pc->offset, vector->values, vector->length,
+							 sizeof(VM_CELL));
+				else
+					simd_set(cell + pc->offset, vector->values, vector->length,
+							 sizeof(VM_CELL));
+				VM_NEXT();
+			}
+
+			for (int k = 0; k < vector->length; k++) {
+				value = (vector->values == NULL)
+						? 0 : ((VM_CELL *)vector->values)[k];
+				if (pc->op == F_VADD) *VM_SPARSE_AT(pc->offset + k) += value;
+				else *VM_SPARSE_AT(pc->offset + k) = value;
+			}
+			VM_NEXT();
+		VM_OP(F_END):
+			return;
+	VM_END()
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un arbre de syntaxe abstraite (AST) sur la bande de données
+ * donnée, avec le moteur choisi par les drapeaux.
+ * 
+ * @param tree L'arbre de syntaxe abstraite (AST) à exécuter.
+ * @param blocks Le programme en blocs de base de l'arbre, abaissé en
+ * programme linéaire pour la VM.
+ * @param tape La première case de la bande de données.
+ * @param start La position initiale du pointeur de données.
+ * @param sparsep Le pointeur vers une bande creuse, ou NULL. Si elle est
+ * donnée, 'tape' est ignorée et le programme linéaire est exécuté sur la bande
+ * creuse, quels que soient les autres drapeaux.
+ */
+static void VM_NAME(execute)(Asttree tree, Block *blocks, void *tape,
+							 long start, Sparsetape *sparsep) {
+	Flatprog prog;
+	Jitcode code;
+	Tier tier;
+	long *exec;
+
+	VM_NAME(ptr) = (VM_CELL *)tape + start;
+
+	if (sparsep != NULL) {
+		prog = flat(blocks);
+		VM_NAME(vectors) = prog.vectors;
+		VM_NAME(execute_sparse)(prog.code, sparsep, start);
+		flat_free(&prog);
+	} else if (options.profile_out != NULL) {
+		prog = flat(blocks);
+		VM_NAME(vectors) = prog.vectors;
+		exec = (long *)calloc(prog.length, sizeof(long));
+		if (exec == NULL)
+			merror("execute() : Échec de l'allocation de mémoire à 'exec' !"
+				   " [%s]", strerror(errno));
+
+		VM_NAME(execute_count)(prog.code, exec);
+		vm_profile(prog, exec);
+
+		free(exec);
+		flat_free(&prog);
+	} else if (options.tree_walker) {
+		VM_NAME(execute_instruction)(tree);
+	} else if (options.jit && JIT_AVAILABLE) {
+		code = jit(tree, sizeof(VM_CELL));
+		jit_run(code, VM_NAME(ptr), NULL);
+		jit_free(&code);
+	} else if (options.tier_threshold > 0 && JIT_AVAILABLE) {
+		prog = flat(blocks);
+		VM_NAME(vectors) = prog.vectors;
+		vm_fuse(&prog);
+		tier = tier_init(&prog, options.tier_threshold, sizeof(VM_CELL),
+						 options.stats);
+		VM_NAME(execute_flat)(prog.code, &tier);
+
+		if (options.stats) tier_print(tier, stderr);
+		tier_free(&tier);
+		flat_free(&prog);
+	} else {
+		prog = flat(blocks);
+		VM_NAME(vectors) = prog.vectors;
+		vm_fuse(&prog);
+		VM_NAME(execute_flat)(prog.code, NULL);
+		flat_free(&prog);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+#undef VM_NAME
+#undef VM_CONCAT
+#undef VM_CONCAT_
+#undef VM_SPARSE_AT
+#undef VM_DO_ADD
+#undef VM_DO_MOVE
+#undef VM_DO_CLEAR
+#undef VM_DO_MUL
+#undef VM_DO_VADD
+#undef VM_DO_VSET
+#undef VM_DO_JZ
+#undef VM_DO_JNZ
+#undef VM_PAIR_LABEL
+#undef VM_TRIPLE_LABEL
+#undef VM_PAIR_HANDLER
+#undef VM_TRIPLE_HANDLER
+#undef VM_CELL
+#undef VM_SUFFIX
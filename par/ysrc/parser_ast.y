@@ -6,6 +6,8 @@ extern int aalex(AASTYPE *lvalp, AALTYPE *llocp);
 extern void aaerror(AALTYPE *llocp, char *s);
 
 extern Asttree prog_tree;
+
+static Asttree legacy_offsets(Asttree tree);
 %}
 
 /* -------------------------------------------------------------------------- */
@@ -26,7 +28,7 @@ extern Asttree prog_tree;
 /* -------------------------------------------------------------------------- */
 
 %token		ROOT OBRA CBRA
-%token<i>	NODE_TYPE LEX SYM
+%token<i>	NODE_TYPE LEX SYM VERSION
 
 %type<t>	sons son node
 
@@ -37,9 +39,17 @@ extern Asttree prog_tree;
 %%
 
 tree :
-		ROOT OBRA sons CBRA
+		VERSION ROOT OBRA sons CBRA
+		{
+			if ($1 != AST_VERSION)
+				merror("Bytecode de version [%d] inconnue (version attendue :"
+					   " %d) !", $1, AST_VERSION);
+			prog_tree = $4;
+		}
+	|	ROOT OBRA sons CBRA
 		{
-			prog_tree = $3;
+			// Bytecode sans version (version 1).
+			prog_tree = legacy_offsets($3);
 		}
 	;
 
@@ -74,4 +84,24 @@ node :
 
 %%
 
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Convertis un arbre lu dans un bytecode sans version : ses
+ * instructions simples portent SYM[-1], qui n'est pas un décalage, et visent
+ * la case pointée.
+ * 
+ * @param tree L'arbre à convertir.
+ * @return Asttree L'arbre converti.
+ */
+static Asttree legacy_offsets(Asttree tree) {
+	for (Asttree node = tree; !ast_is_empty(node);
+		 node = node->little_brother) {
+		if (node->type == A_LOOP) legacy_offsets(node->son);
+		else if (node->id_symb == -1) node->id_symb = 0;
+	}
+
+	return tree;
+}
+
 /* -------------------------------------------------------------------------- */
\ No newline at end of file
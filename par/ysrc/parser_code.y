@@ -62,7 +62,9 @@ instructions :
 instruction :
 		simple_instructions
 		{
-			$$ = ast(ASTDATA_TYPE_TREE, $1.code, $1.count, -1, ast_empty(),
+			// Le champ 'numéro de symbole' est utilisé pour indiquer le
+			// décalage de la case visée par rapport au pointeur.
+			$$ = ast(ASTDATA_TYPE_TREE, $1.code, $1.count, 0, ast_empty(),
 					 ast_empty());
 		}
 	| 	'[' instructions ']'
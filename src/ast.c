@@ -208,8 +208,11 @@ static void ast_print_aux(Asttree tree, char *types[], int depth, FILE *out) {
  * @param types Les chaînes de caractères associées aux types d'arbres
  * possibles.
  * @param out La sortie sur laquelle imprimer l'arbre (Par défaut, stdout).
+ * 
+ * @note L'arbre est précédé de la version du format (voir AST_VERSION).
  */
 void ast_print(Asttree tree, char *types[], FILE *out) {
+	fprintf(out, AST_VERSION_FORMAT "\n", AST_VERSION);
 	fprintf(out, AST_ROOT_STR " " AST_OBRA_STR "\n");
 	ast_print_aux(tree, types, 1, out);
 	fprintf(out, AST_CBRA_STR "\n");
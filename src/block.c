@@ -0,0 +1,594 @@
+/**
+ * @file block.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la représentation en blocs de base d'un programme
+ * Brainfuck : chaque suite d'instructions sans boucle devient un ensemble
+ * d'affectations symboliques de cases (repérées par leur décalage) et
+ * d'entrées/sorties, sur lequel opèrent la propagation de constantes et la
+ * suppression des écritures mortes.
+ * @date 2024-05-22
+ * 
+ * 
+ */
+#include "block.h"
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+extern Options options;
+
+/* -------------------------------------------------------------------------- */
+/*                                 CONSTANTES                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @enum BLOCK_ENTRIES
+ * @brief Énumération de ce qui est connu de la bande à l'entrée d'un noeud.
+ * 
+ */
+enum BLOCK_ENTRIES {
+	BLOCK_UNKNOWN,	///< Rien n'est connu.
+	BLOCK_ZERO,		///< La case pointée est nulle (sortie de boucle).
+	BLOCK_BLANK		///< Toute la bande est nulle (début du programme).
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Blockcell
+ * @struct Blockcell
+ * @brief Structure représentant l'état d'une case pendant l'analyse d'un bloc
+ * de base.
+ * 
+ */
+typedef struct Blockcell {
+	uint32_t value;	///< Valeur de la case (si elle est connue).
+	bool known;		///< Vaut true si la valeur de la case est connue.
+	int pending;	///< Dernier ajout à la case non suivi d'une lecture, ou -1.
+	bool dead;		///< Vaut true si la valeur de la case sera écrasée avant
+					///< d'être lue (parcours arrière).
+} Blockcell;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le masque de la largeur des cases (2^n - 1).
+ * 
+ * @return uint32_t Le masque.
+ */
+static uint32_t block_mask(void) {
+	return (uint32_t)((1ull << options.cell_bits) - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le représentant signé (le plus proche de zéro) d'une valeur
+ * modulo 2^n.
+ * 
+ * @param value La valeur.
+ * @return int Le représentant, dans [-2^(n-1), 2^(n-1)[.
+ */
+static int block_signed(uint32_t value) {
+	uint32_t mask = block_mask();
+
+	value &= mask;
+	return (value > mask / 2) ? -(int)(mask - value) - 1 : (int)value;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne un noeud vide de la sorte donnée.
+ * 
+ * @param kind La sorte du noeud (BLOCK_KINDS).
+ * @return Block* Le noeud créé.
+ */
+static Block *block_new(int kind) {
+	Block *node = (Block *)malloc(sizeof(Block));
+
+	if (node == NULL)
+		merror("block_new() : Échec de l'allocation de mémoire ! [%s]",
+			   strerror(errno));
+
+	*node = (Block){
+		.kind = kind, .ops = NULL, .length = 0, .capacity = 0, .shift = 0,
+		.body = NULL, .node = NULL, .next = NULL
+	};
+
+	return node;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute une opération à la fin d'un bloc de base.
+ * 
+ * @param node Le bloc qui reçoit l'opération.
+ * @param op Le code d'opération (BLOCK_OPS).
+ * @param offset Le décalage de la case visée.
+ * @param arg L'argument de l'opération.
+ * @param source Le décalage de la case multipliée (B_MUL).
+ * 
+ * @note Le tableau d'opérations est agrandi (doublé) si nécessaire.
+ */
+static void block_push(Block *node, int op, int offset, int arg, int source) {
+	Blockop *ops;
+	int capacity;
+
+	if (node->length == node->capacity) {
+		capacity = (node->capacity == 0) ? BLOCK_INITIAL_CAPACITY
+										 : 2 * node->capacity;
+		ops = (Blockop *)realloc(node->ops, capacity * sizeof(Blockop));
+		if (ops == NULL)
+			merror("block_push() : Échec de l'allocation de mémoire à 'ops' !"
+				   " [%s]", strerror(errno));
+
+		node->ops = ops;
+		node->capacity = capacity;
+	}
+
+	node->ops[node->length++] = (Blockop){
+		.op = op, .offset = offset, .arg = arg, .source = source
+	};
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Construit le programme en blocs de base d'un arbre (et de tous ses
+ * petits-frères).
+ * 
+ * @param tree L'arbre à convertir.
+ * @return Block* Le premier noeud du programme (NULL s'il est vide).
+ * 
+ * @note Les déplacements d'une suite sans boucle sont absorbés dans les
+ * décalages de ses opérations : l'arbre n'a pas besoin d'avoir été optimisé.
+ * @note Un type d'arbre inconnu provoquera une erreur.
+ */
+static Block *block_build(Asttree tree) {
+	Block *head = NULL, **link = &head, *basic = NULL, *node;
+	int pos = 0, count, offset;
+
+	for (; !ast_is_empty(tree); tree = tree->little_brother) {
+		if (tree->type != A_LOOP && tree->type != A_SCAN && basic == NULL) {
+			basic = block_new(B_BASIC);
+			pos = 0;
+		}
+
+		count = tree->id_lex;
+		offset = pos + tree->id_symb;
+
+		switch (tree->type) {
+			case A_INC:   block_push(basic, B_ADD, offset, count, 0);  break;
+			case A_DEC:   block_push(basic, B_ADD, offset, -count, 0); break;
+			case A_CLEAR: block_push(basic, B_SET, offset, 0, 0);      break;
+			case A_PUT:   block_push(basic, B_PUT, offset, count, 0);  break;
+			case A_GET:   block_push(basic, B_GET, offset, count, 0);  break;
+			case A_MUL:   block_push(basic, B_MUL, offset, count, pos); break;
+			case A_RIGHT: pos += count; break;
+			case A_LEFT:  pos -= count; break;
+			case A_LOOP:
+			case A_SCAN:
+				// Une boucle termine le bloc de base courant.
+				if (basic != NULL) {
+					basic->shift = pos;
+					*link = basic;
+					link = &basic->next;
+					basic = NULL;
+				}
+
+				if (tree->type == A_LOOP) {
+					node = block_new(B_LOOP);
+					node->body = block_build(tree->son);
+					node->node = tree;
+				} else {
+					node = block_new(B_SCAN);
+					node->shift = count;
+				}
+				*link = node;
+				link = &node->next;
+				break;
+			default:
+				merror("block_build() : 'tree->type' inconnu !");
+		}
+	}
+
+	if (basic != NULL) {
+		basic->shift = pos;
+		*link = basic;
+	}
+
+	return head;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à un bloc de base les opérations du bloc qui le suit, et
+ * libère ce dernier.
+ * 
+ * @param node Le bloc qui reçoit les opérations.
+ * 
+ * @note Les décalages du bloc suivant sont relatifs à la sortie de 'node'.
+ */
+static void block_merge(Block *node) {
+	Block *next = node->next;
+	Blockop op;
+
+	for (int i = 0; i < next->length; i++) {
+		op = next->ops[i];
+		block_push(node, op.op, op.offset + node->shift, op.arg,
+				   op.source + node->shift);
+	}
+
+	node->shift += next->shift;
+	node->next = next->next;
+	next->next = NULL;
+	block_free(&next);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Optimise un bloc de base : propagation des constantes connues à son
+ * entrée (parcours avant), puis suppression des écritures mortes (parcours
+ * arrière).
+ * 
+ * @param node Le bloc à optimiser.
+ * @param entry Ce qui est connu de la bande à l'entrée du bloc
+ * (BLOCK_ENTRIES).
+ * @param sp Le pointeur vers le bilan à compléter.
+ * @return bool Vaut true si la case pointée à la sortie du bloc est nulle.
+ * 
+ * @note Toutes les cases sont considérées comme lues après le bloc : seule
+ * une écriture écrasée dans le bloc lui-même est morte.
+ */
+static bool block_fold(Block *node, int entry, Blockstats *sp) {
+	uint32_t mask = block_mask(), value;
+	int low = 0, high = 0, length = 0;
+	Blockcell *cells, *c, *s;
+	Blockop *op;
+	bool zero;
+
+	if (node->shift < low) low = node->shift;
+	if (node->shift > high) high = node->shift;
+	for (int i = 0; i < node->length; i++) {
+		op = &node->ops[i];
+		if (op->offset < low) low = op->offset;
+		if (op->offset > high) high = op->offset;
+		if (op->op != B_MUL) continue;
+		if (op->source < low) low = op->source;
+		if (op->source > high) high = op->source;
+	}
+
+	cells = (Blockcell *)malloc((high - low + 1) * sizeof(Blockcell));
+	if (cells == NULL)
+		merror("block_fold() : Échec de l'allocation de mémoire à 'cells' !"
+			   " [%s]", strerror(errno));
+
+	for (int k = 0; k <= high - low; k++)
+		cells[k] = (Blockcell){
+			.value = 0, .known = (entry == BLOCK_BLANK), .pending = -1,
+			.dead = false
+		};
+	if (entry == BLOCK_ZERO) cells[-low].known = true;
+
+	// Parcours avant : les opérations supprimées deviennent des ajouts nuls.
+	for (int i = 0; i < node->length; i++) {
+		op = &node->ops[i];
+		c = &cells[op->offset - low];
+
+		switch (op->op) {
+			case B_MUL:
+				s = &cells[op->source - low];
+				if (!s->known) {
+					s->pending = -1;
+					c->known = false;
+					c->pending = -1;
+					break;
+				}
+
+				// Source connue : un simple ajout (ou rien si elle est nulle).
+				sp->constants++;
+				op->op = B_ADD;
+				op->arg = block_signed(s->value * (uint32_t)op->arg);
+				if (op->arg == 0) break;
+				/* FALLTHROUGH */
+			case B_ADD:
+				if ((op->arg & mask) == 0) break;
+
+				if (c->known) {
+					sp->constants++;
+					op->op = B_SET;
+					op->arg = block_signed(c->value + (uint32_t)op->arg);
+					c->value = (uint32_t)op->arg & mask;
+					c->pending = -1;
+				} else if (c->pending >= 0) {
+					sp->merged++;
+					value = (uint32_t)node->ops[c->pending].arg + op->arg;
+					node->ops[c->pending].arg = block_signed(value);
+					op->arg = 0;
+				} else {
+					c->pending = i;
+				}
+				break;
+			case B_SET:
+				value = (uint32_t)op->arg & mask;
+				if (c->known && c->value == value) {
+					sp->constants++;
+					*op = (Blockop){ .op = B_ADD, .offset = op->offset };
+					break;
+				}
+
+				c->known = true;
+				c->value = value;
+				c->pending = -1;
+				break;
+			case B_PUT:
+				c->pending = -1;
+				break;
+			case B_GET:
+				c->known = false;
+				c->pending = -1;
+				break;
+			default:
+				merror("block_fold() : 'op->op' inconnu !");
+		}
+	}
+
+	c = &cells[node->shift - low];
+	zero = c->known && c->value == 0;
+
+	// Parcours arrière : une case écrasée avant d'être lue est morte.
+	for (int i = node->length - 1; i >= 0; i--) {
+		op = &node->ops[i];
+		c = &cells[op->offset - low];
+
+		switch (op->op) {
+			case B_ADD:
+				if ((op->arg & mask) == 0) continue;
+				if (c->dead) {
+					sp->stores++;
+					op->arg = 0;
+				}
+				break;
+			case B_SET:
+				if (c->dead) {
+					sp->stores++;
+					*op = (Blockop){ .op = B_ADD, .offset = op->offset };
+				}
+				c->dead = true;
+				break;
+			case B_MUL:
+				if (c->dead) {
+					sp->stores++;
+					*op = (Blockop){ .op = B_ADD, .offset = op->offset };
+				} else {
+					cells[op->source - low].dead = false;
+				}
+				break;
+			case B_PUT:
+				c->dead = false;
+				break;
+			case B_GET:
+				c->dead = true;
+				break;
+		}
+	}
+
+	free(cells);
+
+	// Compactage : les ajouts nuls sont retirés.
+	for (int i = 0; i < node->length; i++) {
+		op = &node->ops[i];
+		if (op->op == B_ADD && (op->arg & mask) == 0) continue;
+		node->ops[length++] = *op;
+	}
+	node->length = length;
+
+	return zero;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Optimise une suite de noeuds (et les corps de ses boucles).
+ * 
+ * @param link Le pointeur vers le premier noeud de la suite.
+ * @param entry Ce qui est connu de la bande au début de la suite
+ * (BLOCK_ENTRIES).
+ * @param sp Le pointeur vers le bilan à compléter.
+ * 
+ * @note La case pointée est nulle à la sortie d'une boucle ou d'une
+ * recherche : une boucle (ou une recherche) qui commence sur une case connue
+ * nulle est supprimée, et les blocs qui l'entouraient sont fusionnés.
+ */
+static void block_list(Block **link, int entry, Blockstats *sp) {
+	Block *node, *dead;
+	int length;
+	bool zero;
+
+	while ((node = *link) != NULL) {
+		if (node->kind != B_BASIC) {
+			if (entry != BLOCK_UNKNOWN) {
+				sp->loops++;
+				*link = node->next;
+				node->next = NULL;
+				block_free(&node);
+				continue;
+			}
+
+			if (node->kind == B_LOOP)
+				block_list(&node->body, BLOCK_UNKNOWN, sp);
+			entry = BLOCK_ZERO;
+			link = &node->next;
+			continue;
+		}
+
+		while (node->next != NULL && node->next->kind == B_BASIC)
+			block_merge(node);
+
+		// Une écriture morte retirée peut en rendre une autre redondante.
+		do {
+			length = node->length;
+			zero = block_fold(node, entry, sp);
+		} while (node->length < length);
+
+		if (zero && node->next != NULL) {
+			// Boucle morte : le bloc est refait avec celui qui la suit.
+			sp->loops++;
+			dead = node->next;
+			node->next = dead->next;
+			dead->next = NULL;
+			block_free(&dead);
+			continue;
+		}
+
+		if (node->length == 0 && node->shift == 0) {
+			*link = node->next;
+			node->next = NULL;
+			block_free(&node);
+			continue;
+		}
+
+		entry = BLOCK_UNKNOWN;
+		link = &node->next;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compte les blocs de base et les opérations d'une suite de noeuds.
+ * 
+ * @param node Le premier noeud de la suite.
+ * @param sp Le pointeur vers le bilan à compléter.
+ */
+static void block_count(Block *node, Blockstats *sp) {
+	int run;
+
+	for (; node != NULL; node = node->next) {
+		if (node->kind == B_BASIC) {
+			sp->blocks++;
+			sp->ops += node->length;
+			for (int i = 0; i < node->length; i += (run > 0) ? run : 1)
+				if ((run = block_run(node, i)) > 0) sp->vectors++;
+		} else if (node->kind == B_LOOP) {
+			block_count(node->body, sp);
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Construit le programme en blocs de base d'un arbre, et l'optimise si
+ * le niveau d'optimisation est au moins BLOCK_OPT_LEVEL.
+ * 
+ * @param tree L'arbre du programme (ou de son reste).
+ * @param blank Vaut true si toute la bande est nulle au début de l'arbre.
+ * @param statsp Le pointeur vers le bilan à remplir, ou NULL.
+ * @return Block* Le premier noeud du programme (NULL s'il est vide).
+ */
+Block *block_program(Asttree tree, bool blank, Blockstats *statsp) {
+	Blockstats stats = {
+		.blocks = 0, .ops = 0, .constants = 0, .merged = 0, .stores = 0,
+		.loops = 0, .vectors = 0,
+		.optimized = (options.opt_level >= BLOCK_OPT_LEVEL)
+	};
+	Block *prog = block_build(tree);
+
+	if (stats.optimized)
+		block_list(&prog, blank ? BLOCK_BLANK : BLOCK_UNKNOWN, &stats);
+	block_count(prog, &stats);
+
+	if (statsp != NULL) *statsp = stats;
+
+	return prog;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la longueur de la suite vectorielle qui commence à une
+ * opération d'un bloc de base, ou 0.
+ * 
+ * @param node Le bloc de base.
+ * @param i L'indice de la première opération de la suite.
+ * @return int Le nombre d'opérations de la suite (au moins BLOCK_VECTOR_MIN),
+ * ou 0 s'il n'y en a pas.
+ * 
+ * @note Une suite vectorielle est faite d'ajouts (ou d'affectations)
+ * successifs à des cases consécutives, dans un sens ou dans l'autre : ils
+ * touchent des cases distinctes et ne lisent aucune autre case, ils peuvent
+ * donc être appliqués d'un seul coup, sur la case de plus petit décalage.
+ * @note Les suites ne sont cherchées que si les blocs sont optimisés (voir
+ * BLOCK_OPT_LEVEL).
+ */
+int block_run(Block *node, int i) {
+	Blockop *ops = node->ops + i;
+	int length = 1, step;
+
+	if (options.opt_level < BLOCK_OPT_LEVEL || i + 1 >= node->length)
+		return 0;
+	if (ops[0].op != B_ADD && ops[0].op != B_SET) return 0;
+
+	step = ops[1].offset - ops[0].offset;
+	if (step != 1 && step != -1) return 0;
+
+	while (i + length < node->length && ops[length].op == ops[0].op
+		   && ops[length].offset == ops[length - 1].offset + step)
+		length++;
+
+	return (length >= BLOCK_VECTOR_MIN) ? length : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un programme en blocs de base.
+ * 
+ * @param progp Le pointeur vers le premier noeud du programme.
+ */
+void block_free(Block **progp) {
+	Block *node, *next;
+
+	if (progp == NULL) return;
+
+	for (node = *progp; node != NULL; node = next) {
+		next = node->next;
+		block_free(&node->body);
+		free(node->ops);
+		free(node);
+	}
+	*progp = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le bilan d'un programme en blocs de base sur la sortie
+ * donnée.
+ * 
+ * @param stats Le bilan.
+ * @param out La sortie sur laquelle imprimer le bilan.
+ */
+void block_print(Blockstats stats, FILE *out) {
+	fprintf(out, "- Blocs de base : %d bloc(s), %d opération(s)\n",
+			stats.blocks, stats.ops);
+	if (!stats.optimized) return;
+
+	fprintf(out, "  + %d constante(s) propagée(s), %d ajout(s) fusionné(s),"
+			" %d écriture(s) morte(s), %d boucle(s) morte(s)\n",
+			stats.constants, stats.merged, stats.stores, stats.loops);
+	fprintf(out, "  + %d suite(s) vectorielle(s) (%d cases consécutives ou"
+			" plus)\n", stats.vectors, BLOCK_VECTOR_MIN);
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,192 @@
+/**
+ * @file bounds.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'analyse statique des positions atteintes par
+ * le pointeur de données : les boucles dont les accès restent dans un
+ * intervalle connu (relatif à leur entrée) sont marquées "dans les bornes", et
+ * la taille de bande nécessaire au programme est calculée lorsqu'elle est
+ * bornée.
+ * @date 2024-05-20
+ * 
+ * 
+ */
+#include "bounds.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Boundsstate
+ * @struct Boundsstate
+ * @brief Structure représentant l'état de l'analyse d'une suite
+ * d'instructions : la position du pointeur et l'intervalle des cases lues ou
+ * écrites, relatifs au début de la suite.
+ * 
+ * @note Le corps d'une boucle dans les bornes est équilibré : la position du
+ * pointeur est donc toujours exactement connue tant que l'analyse est bornée.
+ */
+typedef struct Boundsstate {
+	bool bounded;	///< Vaut false dès qu'une position est inconnue.
+	long pos;		///< Position du pointeur.
+	long low;		///< Décalage minimal accédé.
+	long high;		///< Décalage maximal accédé.
+	int loops;		///< Nombre de boucles analysées.
+	int inbounds;	///< Nombre de boucles dans les bornes.
+} Boundsstate;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Enregistre l'accès à la case située à 'offset' cases du pointeur.
+ * 
+ * @param sp Le pointeur vers l'état de l'analyse.
+ * @param offset Le décalage de la case.
+ */
+static void bounds_touch(Boundsstate *sp, long offset) {
+	long pos = sp->pos + offset;
+
+	if (pos < sp->low) sp->low = pos;
+	if (pos > sp->high) sp->high = pos;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Analyse une suite d'instructions (et ses boucles internes).
+ * 
+ * @param sp Le pointeur vers l'état de l'analyse.
+ * @param tree La première instruction de la suite.
+ * 
+ * @note Une boucle est dans les bornes si son corps est équilibré et si toutes
+ * ses boucles internes le sont : quel que soit le nombre de tours, ses accès
+ * restent alors dans l'intervalle de ceux d'un tour. Ses décalages extrêmes
+ * sont rangés dans ses champs 'id_lex' (minimal) et 'id_symb' (maximal),
+ * sinon ces champs valent -1 (voir BOUNDS_IS_KNOWN). Une boucle dont l'un des
+ * décalages ne tient pas dans un int n'est pas marquée.
+ */
+static void bounds_list(Boundsstate *sp, Asttree tree) {
+	Boundsstate body;
+
+	for (; !ast_is_empty(tree); tree = tree->little_brother) {
+		switch (tree->type) {
+			case A_RIGHT:
+				sp->pos += tree->id_lex;
+				break;
+			case A_LEFT:
+				sp->pos -= tree->id_lex;
+				break;
+			case A_INC:
+			case A_DEC:
+			case A_PUT:
+			case A_GET:
+			case A_CLEAR:
+				bounds_touch(sp, tree->id_symb);
+				break;
+			case A_MUL:
+				bounds_touch(sp, 0);
+				bounds_touch(sp, tree->id_symb);
+				break;
+			case A_SCAN:
+				bounds_touch(sp, 0);
+				sp->bounded = false;
+				break;
+			case A_LOOP:
+				body = (Boundsstate){
+					.bounded = true, .pos = 0, .low = 0, .high = 0,
+					.loops = 0, .inbounds = 0
+				};
+				bounds_list(&body, tree->son);
+
+				sp->loops += body.loops + 1;
+				sp->inbounds += body.inbounds;
+				tree->id_lex = tree->id_symb = -1;
+
+				if (!body.bounded || body.pos != 0) {
+					sp->bounded = false;
+					break;
+				}
+
+				bounds_touch(sp, body.low);
+				bounds_touch(sp, body.high);
+
+				// Des décalages hors des int ne peuvent pas être rangés dans
+				// le noeud : la boucle n'est alors pas marquée.
+				if (body.low < INT_MIN || body.high > INT_MAX) break;
+
+				tree->id_lex = (int)body.low;
+				tree->id_symb = (int)body.high;
+				sp->inbounds++;
+				break;
+			default:
+				merror("bounds_list() : 'tree->type' inconnu !");
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Analyse les positions atteintes par un programme et marque ses
+ * boucles.
+ * 
+ * @param tree L'arbre (optimisé) du programme.
+ * @param start La position initiale du pointeur de données.
+ * @return Bounds Le résultat de l'analyse.
+ * 
+ * @note Toutes les boucles sont analysées, même après une instruction qui rend
+ * la position inconnue : leurs marques ne dépendent que de leur corps.
+ */
+Bounds bounds(Asttree tree, long start) {
+	Boundsstate state = {
+		.bounded = true, .pos = start, .low = start, .high = start,
+		.loops = 0, .inbounds = 0
+	};
+
+	bounds_list(&state, tree);
+
+	return (Bounds){
+		.bounded = state.bounded, .low = state.low, .high = state.high,
+		.loops = state.loops, .inbounds = state.inbounds
+	};
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nombre de cases de bande nécessaires au programme
+ * analysé.
+ * 
+ * @param b Le résultat de l'analyse.
+ * @param minimum Le nombre minimal de cases (cases déjà initialisées).
+ * @param fallback Le nombre de cases si les positions ne sont pas bornées.
+ * @return long Le nombre de cases.
+ * 
+ * @note Un programme qui accède à une position négative n'est pas borné : il
+ * sortirait de la bande quelle que soit sa taille.
+ */
+long bounds_tape_size(Bounds b, long minimum, long fallback) {
+	if (!b.bounded || b.low < 0)
+		return (fallback > minimum) ? fallback : minimum;
+
+	return (b.high + 1 > minimum) ? b.high + 1 : minimum;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le résultat de l'analyse des bornes sur la sortie donnée.
+ * 
+ * @param b Le résultat de l'analyse.
+ * @param out La sortie sur laquelle imprimer le résultat.
+ */
+void bounds_print(Bounds b, FILE *out) {
+	fprintf(out, "- Bornes : %d boucle(s) sur %d dans les bornes", b.inbounds,
+			b.loops);
+	if (b.bounded) fprintf(out, ", cases [%ld, %ld]\n", b.low, b.high);
+	else fprintf(out, ", positions non bornées\n");
+}
+
+/* -------------------------------------------------------------------------- */
@@ -8,6 +8,10 @@
  */
 #include "compiler.h"
 
+#if defined(__unix__)
+#include <sys/stat.h>
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*                                   PARSER                                   */
 /* -------------------------------------------------------------------------- */
@@ -22,6 +26,7 @@ extern int aalex_destroy(void);
 /* -------------------------------------------------------------------------- */
 
 extern Asttree prog_tree;
+extern Options options;
 
 /* -------------------------------------------------------------------------- */
 /*                                  FONCTIONS                                 */
@@ -54,58 +59,269 @@ static void compile_to_bytecode(char *outpath) {
 	fclose(out);
 }
 
-/* --------------------------------- PYTHON --------------------------------- */
+/* -------------------------- Évaluation partielle -------------------------- */
 
 /**
- * @brief Fonction auxiliaire à ast_to_python.
+ * @def PEVAL_VALUES_PER_LINE
+ * @brief Nombre de valeurs initiales de la bande imprimées par ligne.
+ * 
+ */
+#define PEVAL_VALUES_PER_LINE 16
+
+/**
+ * @def PEVAL_CHARS_PER_LINE
+ * @brief Nombre de caractères (avant échappement) de la sortie du préfixe
+ * imprimés par ligne.
  * 
- * Imprime le programme Python correspondant à l'arbre donné sur la
- * sortie donnée.
+ */
+#define PEVAL_CHARS_PER_LINE 48
+
+/**
+ * @brief Évalue le préfixe d'un programme si l'option d'évaluation partielle
+ * est active.
  * 
- * @param out Le fichier de sortie.
- * @param tree L'arbre à convertir.
- * @param depth La profondeur (indentation) de l'arbre.
+ * @param tree L'arbre (optimisé) du programme.
+ * @return Peval Le résultat de l'évaluation (vide si l'option est inactive).
+ */
+static Peval compile_peval(Asttree tree) {
+	Peval pe = {
+		.rest = tree, .tape = NULL, .cells = 0, .ptr = 0, .output = NULL,
+		.length = 0, .steps = 0, .evaluated = 0, .stop = PEVAL_END
+	};
+
+	if (options.peval_budget <= 0) return pe;
+
+	pe = peval(tree, options.peval_budget, options.cell_bits);
+	if (options.stats) peval_print(pe, stderr);
+
+	return pe;
+}
+
+/* --------------------------------- Bornes --------------------------------- */
+
+/**
+ * @brief Retourne le nombre de cases de la bande du programme généré, après
+ * avoir marqué les boucles du reste du programme (voir bounds.h).
  * 
- * @note Un type d'arbre inconnue provoquera une erreur.
+ * @param pe Le résultat de l'évaluation partielle.
+ * @return long Le nombre de cases.
  */
-static void ast_to_python_aux(FILE *out, Asttree tree, int depth) {
-	int count;
+static long compile_tape_size(Peval pe) {
+	Bounds b = bounds(pe.rest, pe.ptr);
 
-	if (ast_is_empty(tree)) return;
+	if (options.stats) bounds_print(b, stderr);
 
-	// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
-	// d'opérations simples successives.
-	count = tree->id_lex;
+	return bounds_tape_size(b, pe.cells, STACK_LENGTH_DEFAULT);
+}
 
-	switch (tree->type) {
-		case A_LOOP:
+/**
+ * @brief Imprime les valeurs initiales de la bande, séparées par des virgules,
+ * à raison de PEVAL_VALUES_PER_LINE par ligne.
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ * @param depth La profondeur (indentation) des valeurs.
+ */
+static void print_peval_tape(FILE *out, Peval pe, int depth) {
+	for (long i = 0; i < pe.cells; i++) {
+		if (i % PEVAL_VALUES_PER_LINE == 0) print_indent(out, depth);
+		fprintf(out, "%" PRIu32 ",", pe.tape[i]);
+		fprintf(out, (i % PEVAL_VALUES_PER_LINE == PEVAL_VALUES_PER_LINE - 1
+					  || i == pe.cells - 1) ? "\n" : " ");
+	}
+}
+
+/**
+ * @brief Imprime la sortie du préfixe sous la forme de chaînes littérales
+ * (concaténées) C ou Python, à raison d'une chaîne par ligne ; la dernière
+ * est suivie d'une virgule (argument suivant de fwrite ou de write).
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ * @param depth La profondeur (indentation) des chaînes.
+ * @param python Vaut true pour des octets Python (b"..."), false pour une
+ * chaîne C ; chaque valeur est réduite à un octet, comme par putchar.
+ * 
+ * @note Les octets non imprimables sont écrits en octal sur trois chiffres
+ * en C (un chiffre qui suit ne peut pas prolonger l'échappement) et en
+ * hexadécimal en Python, et '?' est échappé en C pour éviter les trigraphes.
+ */
+static void print_peval_output(FILE *out, Peval pe, int depth, bool python) {
+	unsigned char value;
+
+	for (long i = 0; i < pe.length; i++) {
+		if (i % PEVAL_CHARS_PER_LINE == 0) {
 			print_indent(out, depth);
-			fprintf(out, PYTHON_LOOP);
-			ast_to_python_aux(out, tree->son, depth + 1);
-			break;
-		case A_INC:
-			print_simple_inst(out, PYTHON_INC, count, depth);
-			break;
-		case A_DEC:
-			print_simple_inst(out, PYTHON_DEC, count, depth);
-			break;
-		case A_LEFT:
-			print_simple_inst(out, PYTHON_LEFT, count, depth);
-			break;
-		case A_RIGHT:
-			print_simple_inst(out, PYTHON_RIGHT, count, depth);
-			break;
-		case A_PUT:
-			print_simple_inst(out, PYTHON_PUT, count, depth);
-			break;
-		case A_GET:
-			print_simple_inst(out, PYTHON_GET, count, depth);
-			break;
-		default:
-			merror("ast_to_python_aux() : 'tree->type' inconnu !");
+			fprintf(out, python ? "b\"" : "\"");
+		}
+
+		value = (unsigned char)pe.output[i];
+		if (value == '"' || value == '\\' || (!python && value == '?'))
+			fprintf(out, "\\%c", (char)value);
+		else if (value >= ' ' && value <= '~')
+			fputc((int)value, out);
+		else if (!python)
+			fprintf(out, "\\%03o", (unsigned)value);
+		else
+			fprintf(out, "\\x%02x", (unsigned)value);
+
+		if (i == pe.length - 1)
+			fprintf(out, "\",\n");
+		else if (i % PEVAL_CHARS_PER_LINE == PEVAL_CHARS_PER_LINE - 1)
+			fprintf(out, "\"\n");
 	}
+}
 
-	ast_to_python_aux(out, tree->little_brother, depth);
+/* --------------------------------- PYTHON --------------------------------- */
+
+/**
+ * @brief Ajoute une boucle trop profonde à la file des fonctions auxiliaires
+ * et retourne le numéro de sa fonction.
+ * 
+ * @param hp Le pointeur vers la file.
+ * @param loop La boucle.
+ * @return int Le numéro de la fonction auxiliaire.
+ * 
+ * @note Le tableau de boucles est agrandi (doublé) si nécessaire.
+ */
+static int python_helper(Pyhelpers *hp, Block *loop) {
+	Block **loops;
+
+	if (hp->length == hp->capacity) {
+		hp->capacity = (hp->capacity == 0) ? PYTHON_HELPERS_CAPACITY
+										   : 2 * hp->capacity;
+		loops = (Block **)realloc(hp->loops, hp->capacity * sizeof(Block *));
+		if (loops == NULL)
+			merror("python_helper() : Échec de l'allocation de mémoire à"
+				   " 'loops' ! [%s]", strerror(errno));
+
+		hp->loops = loops;
+	}
+
+	hp->loops[hp->length] = loop;
+	return hp->length++;
+}
+
+/**
+ * @brief Teste si un corps de boucle n'imprime aucune instruction Python.
+ * 
+ * @param node Le premier noeud du corps.
+ * @return bool Vaut true si le corps est vide (Python exige alors 'pass').
+ */
+static bool python_is_empty(Block *node) {
+	for (; node != NULL; node = node->next)
+		if (node->kind != B_BASIC || node->length > 0 || node->shift != 0)
+			return false;
+
+	return true;
+}
+
+/**
+ * @brief Imprime le déplacement du pointeur en Python sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param depth La profondeur (indentation) du déplacement.
+ * @param shift Le déplacement (signé, non nul).
+ */
+static void move_to_python(FILE *out, int depth, int shift) {
+	if (shift > 0) print_inst(out, depth, PYTHON_RIGHT_FORMAT, shift);
+	else print_inst(out, depth, PYTHON_LEFT_FORMAT, -shift);
+}
+
+/**
+ * @brief Imprime les opérations d'un bloc de base en Python sur la sortie
+ * donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le bloc de base à convertir.
+ * @param depth La profondeur (indentation) du bloc.
+ * 
+ * @note Les cases sont adressées par leur décalage depuis l'entrée du bloc :
+ * le pointeur n'est déplacé qu'à la sortie du bloc, et le tampon de sortie
+ * n'est comparé à sa taille qu'une fois par bloc qui écrit.
+ */
+static void block_to_python(FILE *out, Block *node, int depth) {
+	uint32_t mask = (uint32_t)((1ull << options.cell_bits) - 1);
+	char *put = (options.cell_bits == 8) ? PYTHON_PUT_FORMAT
+										 : PYTHON_WIDE_PUT_FORMAT;
+	bool written = false;
+	Blockop op;
+
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
+
+		switch (op.op) {
+			case B_ADD:
+				print_inst(out, depth, PYTHON_ADD_FORMAT, op.offset, op.offset,
+						   (op.arg > 0) ? '+' : '-', abs(op.arg));
+				break;
+			case B_SET:
+				print_inst(out, depth, PYTHON_SET_FORMAT, op.offset,
+						   (uint32_t)op.arg & mask);
+				break;
+			case B_PUT:
+				for (int k = 0; k < op.arg; k++)
+					print_inst(out, depth, put, op.offset);
+				written = true;
+				break;
+			case B_GET:
+				for (int k = 0; k < op.arg; k++)
+					print_inst(out, depth, PYTHON_GET_FORMAT, op.offset);
+				break;
+			case B_MUL:
+				print_inst(out, depth, PYTHON_MUL_FORMAT, op.offset, op.offset,
+						   op.source, op.arg);
+				break;
+			default:
+				merror("block_to_python() : 'op.op' inconnu !");
+		}
+	}
+
+	if (written) print_inst(out, depth, PYTHON_PUT_FLUSH);
+	if (node->shift != 0) move_to_python(out, depth, node->shift);
+}
+
+/**
+ * @brief Fonction auxiliaire à ast_to_python.
+ * 
+ * Imprime le programme Python correspondant au programme en blocs de base
+ * donné sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le premier noeud à convertir.
+ * @param depth La profondeur (indentation) des noeuds.
+ * @param level Le nombre de boucles englobantes dans la fonction courante.
+ * @param hp Le pointeur vers la file des fonctions auxiliaires.
+ * 
+ * @note Une boucle au-delà de PYTHON_NESTING_LIMIT devient un appel de
+ * fonction auxiliaire, imprimée après la fonction principale.
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+static void blocks_to_python(FILE *out, Block *node, int depth, int level,
+							 Pyhelpers *hp) {
+	for (; node != NULL; node = node->next) {
+		switch (node->kind) {
+			case B_BASIC:
+				block_to_python(out, node, depth);
+				break;
+			case B_LOOP:
+				if (level >= PYTHON_NESTING_LIMIT) {
+					print_inst(out, depth, PYTHON_CALL_FORMAT,
+							   python_helper(hp, node));
+					break;
+				}
+				print_inst(out, depth, PYTHON_LOOP);
+				if (python_is_empty(node->body))
+					print_inst(out, depth + 1, "pass\n");
+				blocks_to_python(out, node->body, depth + 1, level + 1, hp);
+				break;
+			case B_SCAN:
+				print_inst(out, depth, PYTHON_SCAN_FORMAT, node->shift);
+				break;
+			default:
+				merror("blocks_to_python() : 'node->kind' inconnu !");
+		}
+	}
 }
 
 /**
@@ -114,11 +330,61 @@ static void ast_to_python_aux(FILE *out, Asttree tree, int depth) {
  * 
  * @param out Le fichier de sortie.
  * @param tree L'arbre de syntaxe à convertir.
+ * 
+ * @note Les cases sont réduites modulo 2^n (n étant la largeur des cases)
+ * après chaque opération arithmétique, comme dans la machine virtuelle ; la
+ * bande est un bytearray pour des cases de 8 bits, une liste sinon.
+ * @note Comme en C, le programme est produit à partir des blocs de base du
+ * reste du programme (voir block.h). Les fonctions auxiliaires des boucles
+ * trop profondes sont imprimées après la fonction principale, et peuvent
+ * elles-mêmes en ajouter à la file.
  */
 void ast_to_python(FILE *out, Asttree tree) {
-	fprintf(out, PYTHON_HEADER);
-	ast_to_python_aux(out, tree, 1);
+	Peval pe = compile_peval(tree);
+	Pyhelpers helpers = {NULL, 0, 0};
+	Blockstats bs;
+	Block *blocks;
+
+	fprintf(out, PYTHON_HEADER_FORMAT, compile_tape_size(pe),
+			(unsigned)((1ull << options.cell_bits) - 1),
+			(options.cell_bits == 8) ? PYTHON_BYTES_TAPE : PYTHON_LIST_TAPE);
+
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	// Sortie du préfixe évalué, d'un bloc
+	if (pe.length > 0) {
+		print_inst(out, 1, PYTHON_PEVAL_OUTPUT_BEGIN);
+		print_peval_output(out, pe, 2, true);
+		print_inst(out, 1, PYTHON_PEVAL_OUTPUT_END);
+	}
+
+	// État dans lequel commence le reste du programme
+	if (!ast_is_empty(pe.rest) && pe.cells > 0) {
+		print_inst(out, 1, PYTHON_PEVAL_TAPE_FORMAT, pe.cells);
+		print_peval_tape(out, pe, 2);
+		print_inst(out, 1, "]\n");
+	}
+	if (!ast_is_empty(pe.rest) && pe.ptr != 0)
+		print_inst(out, 1, PYTHON_PEVAL_PTR_FORMAT, pe.ptr);
+
+	blocks_to_python(out, blocks, 1, 0, &helpers);
+	print_inst(out, 1, PYTHON_MAIN_END);
+
+	// Fonctions auxiliaires (la file grandit pendant son parcours)
+	for (int k = 0; k < helpers.length; k++) {
+		fprintf(out, PYTHON_HELPER_FORMAT, k);
+		print_inst(out, 1, PYTHON_LOOP);
+		if (python_is_empty(helpers.loops[k]->body))
+			print_inst(out, 2, "pass\n");
+		blocks_to_python(out, helpers.loops[k]->body, 2, 1, &helpers);
+		print_inst(out, 1, PYTHON_HELPER_END);
+	}
 	fprintf(out, PYTHON_FOOTER);
+
+	free(helpers.loops);
+	block_free(&blocks);
+	peval_free(&pe);
 }
 
 /**
@@ -142,56 +408,167 @@ static void compile_to_python(char *outpath) {
 /* ------------------------------------ C ----------------------------------- */
 
 /**
- * @brief Fonction auxiliaire à ast_to_c.
+ * @brief Imprime le déplacement du pointeur en C sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param depth La profondeur (indentation) du déplacement.
+ * @param shift Le déplacement (signé, non nul).
+ */
+static void move_to_c(FILE *out, int depth, int shift) {
+	if (shift > 0) print_inst(out, depth, C_RIGHT_FORMAT, shift);
+	else print_inst(out, depth, C_LEFT_FORMAT, -shift);
+}
+
+/**
+ * @brief Imprime une suite vectorielle (voir block_run) en C sur la sortie
+ * donnée : son vecteur de constantes, puis son ajout ou son affectation.
  * 
- * Imprime le programme C correspondant à l'arbre donné sur la
- * sortie donnée.
+ * @param out Le fichier de sortie.
+ * @param ops Les opérations de la suite.
+ * @param length Le nombre d'opérations de la suite.
+ * @param pos La position du pointeur, relative à l'entrée du bloc.
+ * @param depth La profondeur (indentation) de la suite.
+ */
+static void vector_to_c(FILE *out, Blockop *ops, int length, int pos,
+						int depth) {
+	uint32_t mask = (uint32_t)((1ull << options.cell_bits) - 1);
+	int low = ops[0].offset, offset, k;
+	bool zero = true;
+
+	for (k = 0; k < length; k++) {
+		if (ops[k].offset < low) low = ops[k].offset;
+		if (ops[k].op == B_ADD || ops[k].arg != 0) zero = false;
+	}
+	offset = low - pos;
+
+	if (zero) {
+		print_inst(out, depth, C_VECTOR_CLEAR_FORMAT, offset, length);
+		return;
+	}
+
+	// Bloc C : le vecteur est local à la suite.
+	print_inst(out, depth, "{\n");
+	print_inst(out, depth + 1, C_VECTOR_FORMAT, length);
+	for (int index = 0; index < length; index++) {
+		for (k = 0; ops[k].offset != low + index; k++);
+		fprintf(out, (index % PEVAL_VALUES_PER_LINE == 0) ? "\n" : " ");
+		if (index % PEVAL_VALUES_PER_LINE == 0) print_indent(out, depth + 2);
+		fprintf(out, "%" PRIu32 ",", (uint32_t)ops[k].arg & mask);
+	}
+	fprintf(out, "\n");
+	print_inst(out, depth + 1, "};\n");
+
+	if (ops[0].op == B_ADD)
+		print_inst(out, depth + 1, C_VECTOR_ADD_FORMAT, length, offset);
+	else
+		print_inst(out, depth + 1, C_VECTOR_SET_FORMAT, offset);
+	print_inst(out, depth, "}\n");
+}
+
+/**
+ * @brief Imprime les opérations d'un bloc de base en C sur la sortie donnée.
  * 
  * @param out Le fichier de sortie.
- * @param tree L'arbre à convertir.
- * @param depth La profondeur (indentation) de l'arbre.
+ * @param node Le bloc de base à convertir.
+ * @param depth La profondeur (indentation) du bloc.
  * 
- * @note Un type d'arbre inconnue provoquera une erreur.
+ * @note Comme dans la VM (voir flat.c), le pointeur n'est déplacé qu'avant
+ * une multiplication et à la sortie du bloc, et une suite vectorielle est
+ * appliquée d'un seul coup.
  */
-static void ast_to_c_aux(FILE *out, Asttree tree, int depth) {
-	int count;
+static void block_to_c(FILE *out, Block *node, int depth) {
+	uint32_t mask = (uint32_t)((1ull << options.cell_bits) - 1);
+	int pos = 0, run;
+	Blockop op;
 
-	if (ast_is_empty(tree)) return;
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
 
-	// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
-	// d'opérations simples successives.
-	count = tree->id_lex;
+		if ((run = block_run(node, i)) > 0) {
+			vector_to_c(out, node->ops + i, run, pos, depth);
+			i += run - 1;
+			continue;
+		}
 
-	switch (tree->type) {
-		case A_LOOP:
-			print_indent(out, depth);
-			fprintf(out, C_LOOP_BEGIN);
-			ast_to_c_aux(out, tree->son, depth + 1);
-			fprintf(out, C_LOOP_END);
-			break;
-		case A_INC:
-			print_simple_inst(out, C_INC, count, depth);
-			break;
-		case A_DEC:
-			print_simple_inst(out, C_DEC, count, depth);
-			break;
-		case A_LEFT:
-			print_simple_inst(out, C_LEFT, count, depth);
-			break;
-		case A_RIGHT:
-			print_simple_inst(out, C_RIGHT, count, depth);
-			break;
-		case A_PUT:
-			print_simple_inst(out, C_PUT, count, depth);
-			break;
-		case A_GET:
-			print_simple_inst(out, C_GET, count, depth);
-			break;
-		default:
-			merror("ast_to_c_aux() : 'tree->type' inconnu !");
+		switch (op.op) {
+			case B_ADD:
+				if (op.arg > 0)
+					print_inst(out, depth, C_INC_FORMAT, op.offset - pos,
+							   op.arg);
+				else
+					print_inst(out, depth, C_DEC_FORMAT, op.offset - pos,
+							   -op.arg);
+				break;
+			case B_SET:
+				print_inst(out, depth, C_SET_FORMAT, op.offset - pos,
+						   (uint32_t)op.arg & mask);
+				break;
+			case B_PUT:
+				for (int k = 0; k < op.arg; k++)
+					print_inst(out, depth, C_PUT_FORMAT, op.offset - pos);
+				break;
+			case B_GET:
+				for (int k = 0; k < op.arg; k++)
+					print_inst(out, depth, C_GET_FORMAT, op.offset - pos);
+				break;
+			case B_MUL:
+				if (op.source != pos) move_to_c(out, depth, op.source - pos);
+				pos = op.source;
+				print_inst(out, depth, C_MUL_FORMAT, op.offset - pos, op.arg);
+				break;
+			default:
+				merror("block_to_c() : 'op.op' inconnu !");
+		}
 	}
 
-	ast_to_c_aux(out, tree->little_brother, depth);
+	if (node->shift != pos) move_to_c(out, depth, node->shift - pos);
+}
+
+/**
+ * @brief Fonction auxiliaire à ast_to_c.
+ * 
+ * Imprime le programme C correspondant au programme en blocs de base donné
+ * sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le premier noeud à convertir.
+ * @param depth La profondeur (indentation) des noeuds.
+ * 
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+static void blocks_to_c(FILE *out, Block *node, int depth) {
+	for (; node != NULL; node = node->next) {
+		switch (node->kind) {
+			case B_BASIC:
+				block_to_c(out, node, depth);
+				break;
+			case B_LOOP:
+				print_indent(out, depth);
+				fprintf(out, C_LOOP_BEGIN);
+				blocks_to_c(out, node->body, depth + 1);
+				print_indent(out, depth);
+				fprintf(out, C_LOOP_END);
+				break;
+			case B_SCAN:
+				print_inst(out, depth, C_SCAN_FORMAT, node->shift);
+				break;
+			default:
+				merror("blocks_to_c() : 'node->kind' inconnu !");
+		}
+	}
+}
+
+/**
+ * @brief Retourne le type C non signé correspondant à la largeur des cases.
+ * 
+ * @return char* Le nom du type.
+ */
+static char *c_cell_type() {
+	switch (options.cell_bits) {
+		case 8:  return "uint8_t";
+		case 16: return "uint16_t";
+		default: return "uint32_t";
+	}
 }
 
 /**
@@ -200,11 +577,48 @@ static void ast_to_c_aux(FILE *out, Asttree tree, int depth) {
  * 
  * @param out Le fichier de sortie.
  * @param tree L'arbre de syntaxe à convertir.
+ * 
+ * @note Les cases sont de type non signé : leur arithmétique est modulaire,
+ * comme dans la machine virtuelle.
+ * @note Comme la VM, le programme C est produit à partir des blocs de base du
+ * reste du programme (voir block.h).
  */
 void ast_to_c(FILE *out, Asttree tree) {
-	fprintf(out, C_HEADER);
-	ast_to_c_aux(out, tree, 1);
+	Peval pe = compile_peval(tree);
+	Blockstats bs;
+	Block *blocks;
+
+	fprintf(out, C_HEADER_FORMAT, compile_tape_size(pe), C_OUTPUT_LENGTH,
+			c_cell_type());
+
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	// Sortie du préfixe évalué, d'un bloc
+	if (pe.length > 0) {
+		print_inst(out, 1, C_PEVAL_OUTPUT_BEGIN);
+		print_peval_output(out, pe, 2, false);
+		print_inst(out, 2, C_PEVAL_OUTPUT_END_FORMAT, pe.length);
+	}
+
+	// État dans lequel commence le reste du programme
+	if (!ast_is_empty(pe.rest) && pe.cells > 0) {
+		print_inst(out, 1, C_PEVAL_TAPE_FORMAT, pe.cells);
+		print_peval_tape(out, pe, 2);
+		print_inst(out, 1, "};\n");
+		print_inst(out, 1, C_PEVAL_COPY);
+	}
+	if (!ast_is_empty(pe.rest) && pe.ptr != 0)
+		print_inst(out, 1, C_RIGHT_FORMAT, (int)pe.ptr);
+
+	// Programme entièrement évalué : la bande n'est jamais utilisée
+	if (ast_is_empty(pe.rest)) print_inst(out, 1, "(void)ptr;\n");
+
+	blocks_to_c(out, blocks, 1);
 	fprintf(out, C_FOOTER);
+
+	block_free(&blocks);
+	peval_free(&pe);
 }
 
 /**
@@ -225,6 +639,616 @@ static void compile_to_c(char *outpath) {
 	fclose(out);
 }
 
+/* ------------------------------- Assembleur ------------------------------- */
+
+/**
+ * @brief Retourne le suffixe de taille des instructions (GNU as) qui accèdent
+ * à une case, selon la largeur des cases.
+ * 
+ * @return char Le suffixe ('b', 'w' ou 'l').
+ */
+static char asm_suffix() {
+	switch (options.cell_bits) {
+		case 8:  return 'b';
+		case 16: return 'w';
+		default: return 'l';
+	}
+}
+
+/**
+ * @brief Retourne le nom de la partie basse de %eax de la largeur des cases.
+ * 
+ * @return char* Le nom du registre.
+ */
+static char *asm_register() {
+	switch (options.cell_bits) {
+		case 8:  return "al";
+		case 16: return "ax";
+		default: return "eax";
+	}
+}
+
+/**
+ * @brief Retourne l'instruction de chargement d'une case dans %eax (avec
+ * extension par des zéros), selon la largeur des cases.
+ * 
+ * @return char* Le nom de l'instruction.
+ */
+static char *asm_load() {
+	switch (options.cell_bits) {
+		case 8:  return "movzbl";
+		case 16: return "movzwl";
+		default: return "movl";
+	}
+}
+
+/**
+ * @brief Imprime les opérations d'un bloc de base en assembleur sur la sortie
+ * donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le bloc de base à convertir.
+ * 
+ * @note Les cases sont adressées par leur décalage depuis l'entrée du bloc :
+ * le pointeur n'est déplacé qu'à la sortie du bloc.
+ */
+static void block_to_asm(FILE *out, Block *node) {
+	uint32_t mask = (uint32_t)((1ull << options.cell_bits) - 1);
+	int size = options.cell_bits / 8;
+	char suffix = asm_suffix();
+	Blockop op;
+
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
+
+		switch (op.op) {
+			case B_ADD:
+				print_inst(out, 1, ASM_ADD_FORMAT, suffix,
+						   (uint32_t)op.arg & mask, op.offset * size);
+				break;
+			case B_SET:
+				print_inst(out, 1, ASM_SET_FORMAT, suffix,
+						   (uint32_t)op.arg & mask, op.offset * size);
+				break;
+			case B_PUT:
+				for (int k = 0; k < op.arg; k++)
+					print_inst(out, 1, ASM_PUT_FORMAT, op.offset * size);
+				break;
+			case B_GET:
+				for (int k = 0; k < op.arg; k++) {
+					print_inst(out, 1, ASM_GET);
+					print_inst(out, 1, ASM_STORE_FORMAT, "mov", suffix,
+							   asm_register(), op.offset * size);
+				}
+				break;
+			case B_MUL:
+				print_inst(out, 1, ASM_LOAD_FORMAT, asm_load(),
+						   op.source * size);
+				if (op.arg != 1 && op.arg != -1)
+					print_inst(out, 1, ASM_FACTOR_FORMAT, op.arg);
+				print_inst(out, 1, ASM_STORE_FORMAT,
+						   (op.arg == -1) ? "sub" : "add", suffix,
+						   asm_register(), op.offset * size);
+				break;
+			default:
+				merror("block_to_asm() : 'op.op' inconnu !");
+		}
+	}
+
+	if (node->shift != 0)
+		print_inst(out, 1, ASM_MOVE_FORMAT, node->shift * size);
+}
+
+/**
+ * @brief Fonction auxiliaire à ast_to_asm.
+ * 
+ * Imprime le programme assembleur correspondant au programme en blocs de base
+ * donné sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le premier noeud à convertir.
+ * @param label Le compteur d'étiquettes (une par boucle ou recherche).
+ * 
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+static void blocks_to_asm(FILE *out, Block *node, int *label) {
+	int size = options.cell_bits / 8, l;
+	char suffix = asm_suffix();
+
+	for (; node != NULL; node = node->next) {
+		switch (node->kind) {
+			case B_BASIC:
+				block_to_asm(out, node);
+				break;
+			case B_LOOP:
+				l = (*label)++;
+				fprintf(out, ASM_LOOP_BEGIN_FORMAT, suffix, l, l);
+				blocks_to_asm(out, node->body, label);
+				fprintf(out, ASM_LOOP_END_FORMAT, suffix, l, l);
+				break;
+			case B_SCAN:
+				l = (*label)++;
+				fprintf(out, ASM_SCAN_FORMAT, suffix, l, l, node->shift * size,
+						suffix, l, l);
+				break;
+			default:
+				merror("blocks_to_asm() : 'node->kind' inconnu !");
+		}
+	}
+}
+
+/**
+ * @brief Imprime la sortie du préfixe en directives .ascii, à raison de
+ * PEVAL_CHARS_PER_LINE caractères (avant échappement) par ligne.
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ * 
+ * @note Comme en C, une valeur est écrite par octet, et les caractères non
+ * imprimables sont écrits en octal sur trois chiffres.
+ */
+static void asm_peval_output(FILE *out, Peval pe) {
+	unsigned char value;
+
+	for (long i = 0; i < pe.length; i++) {
+		if (i % PEVAL_CHARS_PER_LINE == 0) fprintf(out, "\t.ascii \"");
+
+		value = (unsigned char)pe.output[i];
+		if (value == '"' || value == '\\')
+			fprintf(out, "\\%c", (char)value);
+		else if (value >= ' ' && value <= '~')
+			fputc((int)value, out);
+		else
+			fprintf(out, "\\%03o", (unsigned)value);
+
+		if (i == pe.length - 1
+			|| i % PEVAL_CHARS_PER_LINE == PEVAL_CHARS_PER_LINE - 1)
+			fprintf(out, "\"\n");
+	}
+}
+
+/**
+ * @brief Imprime les valeurs initiales de la bande en directives de données
+ * de la largeur des cases, à raison de PEVAL_VALUES_PER_LINE par ligne.
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ */
+static void asm_peval_tape(FILE *out, Peval pe) {
+	char *directive = (options.cell_bits == 8) ? ".byte"
+					: (options.cell_bits == 16) ? ".short" : ".long";
+
+	for (long i = 0; i < pe.cells; i++) {
+		if (i % PEVAL_VALUES_PER_LINE == 0) fprintf(out, "\t%s ", directive);
+		fprintf(out, "%" PRIu32, pe.tape[i]);
+		fprintf(out, (i % PEVAL_VALUES_PER_LINE == PEVAL_VALUES_PER_LINE - 1
+					  || i == pe.cells - 1) ? "\n" : ", ");
+	}
+}
+
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck en
+ * un programme assembleur x86-64 (GNU as, Linux, sans libc).
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ * 
+ * @note Le programme s'assemble et se lie sans bibliothèque C :
+ * "as prog.s -o prog.o && ld prog.o -o prog".
+ * @note Comme en C, le programme est produit à partir des blocs de base du
+ * reste du programme, et une lecture en fin de fichier donne -1 (réduit à la
+ * largeur des cases).
+ */
+void ast_to_asm(FILE *out, Asttree tree) {
+	Peval pe = compile_peval(tree);
+	long cells = compile_tape_size(pe), initialized = 0;
+	int size = options.cell_bits / 8, label = 0;
+	Blockstats bs;
+	Block *blocks;
+
+	fprintf(out, ASM_HEADER);
+
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	// Sortie du préfixe évalué, d'un bloc
+	if (pe.length > 0) print_inst(out, 1, ASM_PEVAL_OUTPUT_FORMAT, pe.length);
+
+	// État dans lequel commence le reste du programme
+	if (!ast_is_empty(pe.rest)) {
+		initialized = (pe.cells < cells) ? pe.cells : cells;
+		if (pe.ptr != 0)
+			print_inst(out, 1, ASM_PEVAL_PTR_FORMAT, pe.ptr * size);
+	}
+
+	blocks_to_asm(out, blocks, &label);
+	fprintf(out, ASM_FOOTER_FORMAT, ASM_BUFFER_LENGTH, ASM_BUFFER_LENGTH,
+			ASM_BUFFER_LENGTH, ASM_BUFFER_LENGTH);
+
+	// Bande : nulle (.bss) ou initialisée par le préfixe (.data)
+	if (initialized > 0) {
+		fprintf(out, ASM_PEVAL_TAPE_FORMAT, ASM_TAPE_MARGIN);
+		pe.cells = initialized;
+		asm_peval_tape(out, pe);
+		if (cells > initialized)
+			fprintf(out, "\t.zero %ld\n", (cells - initialized) * size);
+	} else {
+		fprintf(out, ASM_TAPE_FORMAT, ASM_TAPE_MARGIN, cells * size);
+	}
+
+	if (pe.length > 0) {
+		fprintf(out, ASM_PEVAL_OUTPUT_BEGIN);
+		asm_peval_output(out, pe);
+	}
+
+	block_free(&blocks);
+	peval_free(&pe);
+}
+
+/**
+ * @brief Convertis l'arbre de syntaxe abstraite global en un programme
+ * assembleur.
+ * 
+ * @param outpath Le fichier de sortie.
+ */
+static void compile_to_asm(char *outpath) {
+	// Ouverture du fichier de sortie
+	FILE *out = fopen(outpath, "w+");
+	if (out == NULL)
+		merror("compile_to_asm() : Échec de l'ouverture du fichier \"%s\"",
+			   outpath);
+	
+	// Compilation
+	ast_to_asm(out, prog_tree);
+
+	fclose(out);
+}
+
+/* ---------------------------------- LLVM ---------------------------------- */
+
+/**
+ * @brief Retourne le type LLVM des cases, selon leur largeur.
+ * 
+ * @return char* Le nom du type.
+ */
+static char *llvm_cell_type() {
+	switch (options.cell_bits) {
+		case 8:  return "i8";
+		case 16: return "i16";
+		default: return "i32";
+	}
+}
+
+/**
+ * @brief Retourne le représentant signé (le plus proche de zéro) d'une valeur
+ * modulo 2^n : les constantes LLVM d'un type iN sont écrites dans
+ * [-2^(n-1), 2^(n-1)[.
+ * 
+ * @param value La valeur.
+ * @return int Le représentant.
+ */
+static int llvm_signed(uint32_t value) {
+	uint32_t mask = (uint32_t)((1ull << options.cell_bits) - 1);
+
+	value &= mask;
+	return (value > mask / 2) ? -(int)(mask - value) - 1 : (int)value;
+}
+
+/**
+ * @brief Imprime l'adresse d'une case décalée en LLVM IR sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param base La valeur du pointeur à l'entrée du bloc.
+ * @param offset Le décalage de la case.
+ * @param id Le compteur de valeurs.
+ * @return int La valeur contenant l'adresse de la case.
+ */
+static int llvm_cell(FILE *out, int base, int offset, int *id) {
+	if (offset == 0) return base;
+
+	print_inst(out, 1, LLVM_CELL_FORMAT, *id, llvm_cell_type(), base, offset);
+	return (*id)++;
+}
+
+/**
+ * @brief Imprime les opérations d'un bloc de base en LLVM IR sur la sortie
+ * donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le bloc de base à convertir.
+ * @param id Le compteur de valeurs (%tN) et d'étiquettes (LN).
+ * 
+ * @note Le pointeur est chargé à l'entrée du bloc, les cases sont adressées
+ * par leur décalage, et le pointeur déplacé n'est enregistré qu'à la sortie.
+ */
+static void block_to_llvm(FILE *out, Block *node, int *id) {
+	int size = options.cell_bits / 8, base = (*id)++, cell, value, t;
+	char *type = llvm_cell_type();
+	Blockop op;
+
+	print_inst(out, 1, LLVM_BASE_FORMAT, base);
+
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
+		cell = llvm_cell(out, base, op.offset, id);
+
+		switch (op.op) {
+			case B_ADD:
+				value = (*id)++;
+				print_inst(out, 1, LLVM_LOAD_FORMAT, value, type, cell, size);
+				t = (*id)++;
+				print_inst(out, 1, LLVM_BINARY_FORMAT, t, "add", type, value,
+						   llvm_signed((uint32_t)op.arg));
+				print_inst(out, 1, LLVM_STORE_FORMAT, type, t, cell, size);
+				break;
+			case B_SET:
+				print_inst(out, 1, LLVM_SET_FORMAT, type,
+						   llvm_signed((uint32_t)op.arg), cell, size);
+				break;
+			case B_PUT:
+				for (int k = 0; k < op.arg; k++) {
+					value = (*id)++;
+					print_inst(out, 1, LLVM_LOAD_FORMAT, value, type, cell,
+							   size);
+					if (options.cell_bits < 32) {
+						print_inst(out, 1, LLVM_CAST_FORMAT, *id, "zext", type,
+								   value, "i32");
+						value = (*id)++;
+					}
+					print_inst(out, 1, LLVM_PUT_FORMAT, value);
+				}
+				break;
+			case B_GET:
+				for (int k = 0; k < op.arg; k++) {
+					value = (*id)++;
+					print_inst(out, 1, LLVM_GET_FORMAT, value);
+					if (options.cell_bits < 32) {
+						print_inst(out, 1, LLVM_CAST_FORMAT, *id, "trunc",
+								   "i32", value, type);
+						value = (*id)++;
+					}
+					print_inst(out, 1, LLVM_STORE_FORMAT, type, value, cell,
+							   size);
+				}
+				break;
+			case B_MUL:
+				t = llvm_cell(out, base, op.source, id);
+				value = (*id)++;
+				print_inst(out, 1, LLVM_LOAD_FORMAT, value, type, t, size);
+				t = (*id)++;
+				print_inst(out, 1, LLVM_BINARY_FORMAT, t, "mul", type, value,
+						   llvm_signed((uint32_t)op.arg));
+				value = (*id)++;
+				print_inst(out, 1, LLVM_LOAD_FORMAT, value, type, cell, size);
+				print_inst(out, 1, LLVM_SUM_FORMAT, *id, type, value, t);
+				print_inst(out, 1, LLVM_STORE_FORMAT, type, (*id)++, cell,
+						   size);
+				break;
+			default:
+				merror("block_to_llvm() : 'op.op' inconnu !");
+		}
+	}
+
+	if (node->shift != 0)
+		print_inst(out, 1, LLVM_MOVE_FORMAT,
+				   llvm_cell(out, base, node->shift, id));
+}
+
+/**
+ * @brief Fonction auxiliaire à ast_to_llvm.
+ * 
+ * Imprime le programme LLVM IR correspondant au programme en blocs de base
+ * donné sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param node Le premier noeud à convertir.
+ * @param id Le compteur de valeurs (%tN) et d'étiquettes (LN).
+ * 
+ * @note Chaque boucle devient un bloc de test, suivi de son corps et d'un
+ * bloc de sortie ; une recherche de case nulle est une boucle dont le corps
+ * déplace le pointeur chargé par le test.
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+static void blocks_to_llvm(FILE *out, Block *node, int *id) {
+	int size = options.cell_bits / 8, l;
+	char *type = llvm_cell_type();
+
+	for (; node != NULL; node = node->next) {
+		if (node->kind == B_BASIC) {
+			block_to_llvm(out, node, id);
+			continue;
+		}
+		if (node->kind != B_LOOP && node->kind != B_SCAN)
+			merror("blocks_to_llvm() : 'node->kind' inconnu !");
+
+		// Test : %tl (pointeur), %tl+1 (case), %tl+2 (case non nulle)
+		l = *id;
+		*id += 3;
+		fprintf(out, LLVM_LOOP_BEGIN_FORMAT, l, l, l, l + 1, type, l, size,
+				l + 2, type, l + 1, l + 2, l, l, l);
+
+		if (node->kind == B_LOOP) blocks_to_llvm(out, node->body, id);
+		else print_inst(out, 1, LLVM_MOVE_FORMAT,
+						llvm_cell(out, l, node->shift, id));
+
+		fprintf(out, LLVM_LOOP_END_FORMAT, l, l);
+	}
+}
+
+/**
+ * @brief Imprime la sortie du préfixe en une constante LLVM (chaîne c"..."),
+ * les caractères non imprimables étant écrits en hexadécimal (\XX).
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ */
+static void llvm_peval_output(FILE *out, Peval pe) {
+	unsigned char value;
+
+	fprintf(out, LLVM_PEVAL_OUTPUT_BEGIN_FORMAT, pe.length);
+	for (long i = 0; i < pe.length; i++) {
+		value = (unsigned char)pe.output[i];
+		if (value >= ' ' && value <= '~' && value != '"' && value != '\\')
+			fputc((int)value, out);
+		else
+			fprintf(out, "\\%02X", (unsigned)value);
+	}
+	fprintf(out, "\", align 1\n");
+}
+
+/**
+ * @brief Imprime la bande, précédée de sa marge, en une variable globale
+ * LLVM : nulle, ou initialisée par le préfixe évalué.
+ * 
+ * @param out Le fichier de sortie.
+ * @param pe Le résultat de l'évaluation.
+ * @param cells Le nombre de cases de la bande.
+ * @param initialized Le nombre de cases initialisées par le préfixe.
+ */
+static void llvm_tape(FILE *out, Peval pe, long cells, long initialized) {
+	long margin = LLVM_TAPE_MARGIN / (options.cell_bits / 8);
+	char *type = llvm_cell_type();
+
+	if (initialized == 0) {
+		fprintf(out, LLVM_TAPE_FORMAT, margin + cells, type);
+		return;
+	}
+
+	fprintf(out, LLVM_PEVAL_TAPE_FORMAT, margin, type, initialized, type,
+			cells - initialized, type, margin, type, initialized, type);
+	for (long i = 0; i < initialized; i++) {
+		if (i % PEVAL_VALUES_PER_LINE == 0) print_indent(out, 2);
+		fprintf(out, "%s %d", type, llvm_signed(pe.tape[i]));
+		if (i < initialized - 1) fprintf(out, ",");
+		fprintf(out, (i % PEVAL_VALUES_PER_LINE == PEVAL_VALUES_PER_LINE - 1
+					  || i == initialized - 1) ? "\n" : " ");
+	}
+	fprintf(out, LLVM_PEVAL_TAPE_END_FORMAT, cells - initialized, type);
+}
+
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck en
+ * un module LLVM IR textuel.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ * 
+ * @note Le module n'a besoin d'aucune bibliothèque LLVM, seulement de la
+ * bibliothèque C (putchar, getchar) à l'édition de liens :
+ * "clang -O2 prog.ll -o prog", ou "llc prog.ll && cc prog.s -o prog".
+ * @note La bande est une variable globale de cases de la largeur choisie,
+ * précédée d'une marge nulle (voir ASM_TAPE_MARGIN).
+ */
+void ast_to_llvm(FILE *out, Asttree tree) {
+	Peval pe = compile_peval(tree);
+	long cells = compile_tape_size(pe), initialized = 0, start = 0;
+	int size = options.cell_bits / 8, id = 0;
+	Blockstats bs;
+	Block *blocks;
+
+	// État dans lequel commence le reste du programme
+	if (!ast_is_empty(pe.rest)) {
+		initialized = (pe.cells < cells) ? pe.cells : cells;
+		start = pe.ptr * size;
+	}
+	fprintf(out, LLVM_HEADER_FORMAT, LLVM_TAPE_MARGIN + start);
+
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	// Sortie du préfixe évalué, d'un bloc
+	if (pe.length > 0)
+		fprintf(out, LLVM_PEVAL_OUTPUT_FORMAT, pe.length, pe.length);
+
+	blocks_to_llvm(out, blocks, &id);
+	fprintf(out, LLVM_FOOTER);
+
+	llvm_tape(out, pe, cells, initialized);
+	if (pe.length > 0) llvm_peval_output(out, pe);
+
+	block_free(&blocks);
+	peval_free(&pe);
+}
+
+/**
+ * @brief Convertis l'arbre de syntaxe abstraite global en un module LLVM IR.
+ * 
+ * @param outpath Le fichier de sortie.
+ */
+static void compile_to_llvm(char *outpath) {
+	// Ouverture du fichier de sortie
+	FILE *out = fopen(outpath, "w+");
+	if (out == NULL)
+		merror("compile_to_llvm() : Échec de l'ouverture du fichier \"%s\"",
+			   outpath);
+	
+	// Compilation
+	ast_to_llvm(out, prog_tree);
+
+	fclose(out);
+}
+
+/* ----------------------------------- ELF ---------------------------------- */
+
+/**
+ * @brief Convertis l'arbre de syntaxe abstraite global en un exécutable ELF
+ * x86-64 statique (voir elf.h), rendu exécutable.
+ * 
+ * @param outpath Le fichier de sortie.
+ * 
+ * @note Aucun outil externe n'est appelé : le code machine est produit à
+ * partir des blocs de base du reste du programme, comme en assembleur.
+ */
+static void compile_to_elf(char *outpath) {
+	Peval pe = compile_peval(prog_tree);
+	long cells = compile_tape_size(pe);
+	Blockstats bs;
+	Block *blocks;
+
+	// Ouverture du fichier de sortie
+	FILE *out = fopen(outpath, "wb");
+	if (out == NULL)
+		merror("compile_to_elf() : Échec de l'ouverture du fichier \"%s\"",
+			   outpath);
+
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	// Compilation
+	elf_program(out, blocks, pe, cells);
+
+	fclose(out);
+#if defined(__unix__)
+	if (chmod(outpath, 0755) != 0)
+		mwarning("compile_to_elf() : Échec du passage en exécutable de \"%s\""
+				 " [%s]", outpath, strerror(errno));
+#endif
+
+	block_free(&blocks);
+	peval_free(&pe);
+}
+
+/* -------------------------------- Brainfuck ------------------------------- */
+
+/**
+ * @brief Convertis l'arbre de syntaxe abstraite global (simplifié par
+ * ast_minify) en un programme Brainfuck minimal.
+ * 
+ * @param outpath Le fichier de sortie.
+ */
+static void compile_to_minified(char *outpath) {
+	// Ouverture du fichier de sortie
+	FILE *out = fopen(outpath, "w+");
+	if (out == NULL)
+		merror("compile_to_minified() : Échec de l'ouverture du fichier"
+			   " \"%s\"", outpath);
+
+	// Compilation
+	ast_to_minified(out, prog_tree);
+
+	fclose(out);
+}
+
 /* -------------------------------------------------------------------------- */
 
 /**
@@ -242,6 +1266,10 @@ static int compiler_mode(char *option, char *option_arg) {
 	if (strcmp(option, CMODE_BOPTION) == 0) {
 		if (strcmp(option_arg, CMODE_PC_ARG) == 0) return CMODE_BPC;
 		if (strcmp(option_arg, CMODE_CC_ARG) == 0) return CMODE_BCC;	
+		if (strcmp(option_arg, CMODE_AC_ARG) == 0) return CMODE_BAC;
+		if (strcmp(option_arg, CMODE_LC_ARG) == 0) return CMODE_BLC;
+		if (strcmp(option_arg, CMODE_EC_ARG) == 0) return CMODE_BEC;
+		if (strcmp(option_arg, CMODE_MC_ARG) == 0) return CMODE_BMC;
 		
 		merror("compiler_mode() : Argument [%s] inconnu !", option_arg);
 
@@ -249,6 +1277,10 @@ static int compiler_mode(char *option, char *option_arg) {
 		if (strcmp(option_arg, CMODE_BC_ARG) == 0) return CMODE_CBC;
 		if (strcmp(option_arg, CMODE_PC_ARG) == 0) return CMODE_CPC;
 		if (strcmp(option_arg, CMODE_CC_ARG) == 0) return CMODE_CCC;
+		if (strcmp(option_arg, CMODE_AC_ARG) == 0) return CMODE_CAC;
+		if (strcmp(option_arg, CMODE_LC_ARG) == 0) return CMODE_CLC;
+		if (strcmp(option_arg, CMODE_EC_ARG) == 0) return CMODE_CEC;
+		if (strcmp(option_arg, CMODE_MC_ARG) == 0) return CMODE_CMC;
 	
 		merror("compiler_mode() : Argument [%s] inconnu/incompatible !",
 			   option_arg);
@@ -289,12 +1321,26 @@ void compile(int argc, char *argv[]) {
 	switch (mode) {
 		case CMODE_BCC:
 		case CMODE_BPC:
+		case CMODE_BAC:
+		case CMODE_BLC:
+		case CMODE_BEC:
+		case CMODE_BMC:
 			parse(inpath, &aain, aaparse, aalex_destroy); break;
 		case CMODE_CCC:
 		case CMODE_CBC:
-		case CMODE_CPC: parse(inpath, &ccin, ccparse, cclex_destroy); break;
+		case CMODE_CPC:
+		case CMODE_CAC:
+		case CMODE_CLC:
+		case CMODE_CEC:
+		case CMODE_CMC: parse(inpath, &ccin, ccparse, cclex_destroy); break;
 	}
 
+	// Optimisation (le programme minimal n'a que ses propres passes)
+	if (mode == CMODE_CMC || mode == CMODE_BMC)
+		prog_tree = ast_minify(prog_tree);
+	else
+		prog_tree = optimize(prog_tree);
+
 	// Compilation
 	switch (mode) {
 		case CMODE_CBC: compile_to_bytecode(outpath); break;
@@ -302,6 +1348,14 @@ void compile(int argc, char *argv[]) {
 		case CMODE_BPC: compile_to_python(outpath);   break;
 		case CMODE_CCC:
 		case CMODE_BCC: compile_to_c(outpath);		  break;
+		case CMODE_CAC:
+		case CMODE_BAC: compile_to_asm(outpath);	  break;
+		case CMODE_CLC:
+		case CMODE_BLC: compile_to_llvm(outpath);	  break;
+		case CMODE_CEC:
+		case CMODE_BEC: compile_to_elf(outpath);	  break;
+		case CMODE_CMC:
+		case CMODE_BMC: compile_to_minified(outpath); break;
 	}
 
 	ast_free(prog_tree);
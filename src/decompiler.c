@@ -21,11 +21,258 @@ extern int aalex_destroy();
 /* -------------------------------------------------------------------------- */
 
 extern Asttree prog_tree;
+extern Options options;
 
 /* -------------------------------------------------------------------------- */
 /*                                  FONCTIONS                                 */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Imprime les instructions Brainfuck correspondant à un déplacement
+ * (signé) du pointeur de données.
+ * 
+ * @param out Le fichier de sortie.
+ * @param moves Le déplacement à imprimer.
+ */
+static void print_moves(FILE *out, int moves) {
+	if (moves > 0) print_simple_inst(out, BRAINFUCK_RIGHT, moves, 0);
+	else print_simple_inst(out, BRAINFUCK_LEFT, -moves, 0);
+}
+
+/**
+ * @brief Imprime les instructions Brainfuck correspondant à l'ajout (signé)
+ * d'une valeur à la case pointée, par la plus courte des deux suites
+ * équivalentes modulo 2^n (n étant la largeur des cases).
+ * 
+ * @param out Le fichier de sortie.
+ * @param value La valeur à ajouter.
+ * 
+ * @note En 8 bits, 200 s'imprime ainsi par 56 '-' plutôt que 200 '+'.
+ */
+static void print_add(FILE *out, long long value) {
+	long long modulus = 1ll << options.cell_bits;
+	long long up = ((value % modulus) + modulus) % modulus;
+
+	if (up <= modulus - up) print_simple_inst(out, BRAINFUCK_INC, (int)up, 0);
+	else print_simple_inst(out, BRAINFUCK_DEC, (int)(modulus - up), 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime la boucle Brainfuck correspondant à une suite de noeuds A_MUL
+ * suivie de la remise à zéro (A_CLEAR) du compteur, et retourne cette remise
+ * à zéro.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree Le premier noeud A_MUL de la suite.
+ * @return Asttree Le noeud de remise à zéro du compteur.
+ * 
+ * @note Une suite qui ne se termine pas par A_CLEAR provoquera une erreur.
+ */
+static Asttree mul_to_brainfuck(FILE *out, Asttree tree) {
+	fprintf(out, BRAINFUCK_LOOP_BEGIN BRAINFUCK_DEC);
+	for (; !ast_is_empty(tree) && tree->type == A_MUL;
+		 tree = tree->little_brother) {
+		print_moves(out, tree->id_symb);
+		print_add(out, tree->id_lex);
+		print_moves(out, -tree->id_symb);
+	}
+	fprintf(out, BRAINFUCK_LOOP_END);
+
+	if (ast_is_empty(tree) || tree->type != A_CLEAR || tree->id_symb != 0)
+		merror("mul_to_brainfuck() : Multiplication sans remise à zéro !");
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Teste si un noeud appartient à une suite de modifications de cases
+ * (incrémentations, décrémentations et remises à zéro), qui commutent tant
+ * qu'elles visent des cases différentes.
+ * 
+ * @param tree Le noeud.
+ * @return bool Vaut true si le noeud modifie seulement une case.
+ */
+static bool is_update(Asttree tree) {
+	return !ast_is_empty(tree) && (tree->type == A_INC || tree->type == A_DEC
+								   || tree->type == A_CLEAR);
+}
+
+/**
+ * @brief Imprime l'effet net d'une suite de modifications de cases (voir
+ * is_update) sur une case, puis y laisse le pointeur.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree Le premier noeud de la suite.
+ * @param offset Le décalage de la case.
+ * @param pos La position du pointeur imprimé par rapport au pointeur de
+ * l'arbre.
+ */
+static void cell_to_brainfuck(FILE *out, Asttree tree, int offset, int *pos) {
+	long long value = 0, modulus = 1ll << options.cell_bits;
+	bool cleared = false;
+
+	for (; is_update(tree); tree = tree->little_brother) {
+		if (tree->id_symb != offset) continue;
+
+		if (tree->type == A_CLEAR) {
+			cleared = true;
+			value = 0;
+		} else
+			value += (tree->type == A_INC) ? tree->id_lex : -tree->id_lex;
+	}
+
+	value %= modulus;
+	if (!cleared && value == 0) return;
+
+	print_moves(out, offset - *pos);
+	*pos = offset;
+	if (cleared)
+		fprintf(out, BRAINFUCK_LOOP_BEGIN BRAINFUCK_DEC BRAINFUCK_LOOP_END);
+	print_add(out, value);
+}
+
+/**
+ * @brief Imprime une suite de modifications de cases (voir is_update) par son
+ * effet net sur chaque case, les cases étant visitées dans l'ordre croissant
+ * ou décroissant de leur décalage (en commençant par l'extrémité la plus
+ * proche du pointeur), et retourne le dernier noeud de la suite.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree Le premier noeud de la suite.
+ * @param pos La position du pointeur imprimé par rapport au pointeur de
+ * l'arbre.
+ * @return Asttree Le dernier noeud de la suite.
+ */
+static Asttree updates_to_brainfuck(FILE *out, Asttree tree, int *pos) {
+	int low = tree->id_symb, high = tree->id_symb, offset, next;
+	Asttree last = tree, node;
+	bool up;
+
+	for (node = tree; is_update(node); node = node->little_brother) {
+		if (node->id_symb < low) low = node->id_symb;
+		if (node->id_symb > high) high = node->id_symb;
+		last = node;
+	}
+
+	up = abs(*pos - low) <= abs(*pos - high);
+	for (offset = up ? low : high;;) {
+		cell_to_brainfuck(out, tree, offset, pos);
+
+		// Case suivante de la suite, dans le sens du parcours
+		next = offset;
+		for (node = tree; is_update(node); node = node->little_brother)
+			if ((up && node->id_symb > offset
+				 && (next == offset || node->id_symb < next))
+				|| (!up && node->id_symb < offset
+					&& (next == offset || node->id_symb > next)))
+				next = node->id_symb;
+
+		if (next == offset) break;
+		offset = next;
+	}
+
+	return last;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fonction auxiliaire à ast_to_brainfuck et à ast_to_minified.
+ * 
+ * Imprime le programme Brainfuck correspondant à l'arbre donné sur la sortie
+ * donnée.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre à convertir.
+ * @param pos La position du pointeur imprimé par rapport au pointeur de
+ * l'arbre.
+ * @param minify Vaut true pour imprimer les suites de modifications de cases
+ * par leur effet net (voir updates_to_brainfuck).
+ * 
+ * @note Les opérations adressées par décalage sont imprimées en déplaçant le
+ * pointeur jusqu'à leur case ; les déplacements de l'arbre ne sont imprimés
+ * qu'avant une boucle ou à la fin d'une suite d'instructions, ce qui évite
+ * les allers-retours inutiles.
+ * @note Un type d'arbre inconnu provoquera une erreur.
+ */
+static void ast_to_brainfuck_aux(FILE *out, Asttree tree, int *pos,
+								 bool minify) {
+	int count, offset, body;
+
+	for (; !ast_is_empty(tree); tree = tree->little_brother) {
+		// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
+		// d'opérations simples successives, et le champ 'numéro de symbole' le
+		// décalage de la case visée.
+		count = tree->id_lex;
+		offset = tree->id_symb;
+
+		if (minify && is_update(tree)) {
+			tree = updates_to_brainfuck(out, tree, pos);
+			continue;
+		}
+
+		switch (tree->type) {
+			case A_LEFT:
+				*pos += count;
+				continue;
+			case A_RIGHT:
+				*pos -= count;
+				continue;
+			case A_INC:
+			case A_DEC:
+			case A_PUT:
+			case A_GET:
+			case A_CLEAR:
+				print_moves(out, offset - *pos);
+				*pos = offset;
+				break;
+			default:
+				print_moves(out, -*pos);
+				*pos = 0;
+		}
+
+		switch (tree->type) {
+			case A_LOOP:
+				body = 0;
+				fprintf(out, BRAINFUCK_LOOP_BEGIN);
+				ast_to_brainfuck_aux(out, tree->son, &body, minify);
+				print_moves(out, -body);
+				fprintf(out, BRAINFUCK_LOOP_END);
+				break;
+			case A_INC:
+				print_add(out, count);
+				break;
+			case A_DEC:
+				print_add(out, -(long long)count);
+				break;
+			case A_PUT:
+				print_simple_inst(out, BRAINFUCK_PUT, count, 0);
+				break;
+			case A_GET:
+				print_simple_inst(out, BRAINFUCK_GET, count, 0);
+				break;
+			case A_CLEAR:
+				fprintf(out, BRAINFUCK_LOOP_BEGIN BRAINFUCK_DEC
+						BRAINFUCK_LOOP_END);
+				break;
+			case A_SCAN:
+				fprintf(out, BRAINFUCK_LOOP_BEGIN);
+				print_moves(out, count);
+				fprintf(out, BRAINFUCK_LOOP_END);
+				break;
+			case A_MUL:
+				tree = mul_to_brainfuck(out, tree);
+				break;
+			default:
+				merror("ast_to_brainfuck_aux() : 'tree->type' inconnu !");
+		}
+	}
+}
+
 /**
  * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck en
  * programme Brainfuck.
@@ -34,43 +281,65 @@ extern Asttree prog_tree;
  * @param tree L'arbre de syntaxe à convertir.
  */
 void ast_to_brainfuck(FILE *out, Asttree tree) {
-	int count;
-
-	if (tree == NULL) return;
-
-	// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
-	// d'opérations simples successives.
-	count = tree->id_lex;
-
-	switch (tree->type) {
-		case A_LOOP:
-			fprintf(out, BRAINFUCK_LOOP_BEGIN);
-			ast_to_brainfuck(out, tree->son);
-			fprintf(out, BRAINFUCK_LOOP_END);
-			break;
-		case A_INC:
-			print_simple_inst(out, BRAINFUCK_INC, count, 0);
-			break;
-		case A_DEC:
-			print_simple_inst(out, BRAINFUCK_DEC, count, 0);
-			break;
-		case A_LEFT:
-			print_simple_inst(out, BRAINFUCK_LEFT, count, 0);
-			break;
-		case A_RIGHT:
-			print_simple_inst(out, BRAINFUCK_RIGHT, count, 0);
-			break;
-		case A_PUT:
-			print_simple_inst(out, BRAINFUCK_PUT, count, 0);
-			break;
-		case A_GET:
-			print_simple_inst(out, BRAINFUCK_GET, count, 0);
-			break;
-		default:
-			merror("ast_to_brainfuck() : 'tree->type' inconnu !");
-	}
+	int pos = 0;
+
+	ast_to_brainfuck_aux(out, tree, &pos, false);
+	print_moves(out, -pos);
+}
+
+/**
+ * @brief Met un arbre de syntaxe abstraite sous la forme canonique attendue
+ * par ast_to_minified.
+ * 
+ * @param tree L'arbre à simplifier.
+ * @return Asttree L'arbre simplifié.
+ * 
+ * @note Seules la suppression du code mort et l'adressage par décalage sont
+ * appliqués (voir optimize_dead et optimize_offsets) : les autres passes
+ * produisent du code (multiplications, déroulage) qui s'écrit plus
+ * longuement en Brainfuck.
+ * @note Les déplacements et modifications de cases qui suivent la dernière
+ * boucle ou entrée/sortie du programme ne sont pas observables : ils sont
+ * supprimés.
+ * @note L'arbre donné est modifié en place : les noeuds supprimés sont
+ * libérés.
+ */
+Asttree ast_minify(Asttree tree) {
+	Asttree *linkp, *tailp;
+	int removed;
+
+	tree = optimize_dead(tree, &removed);
+	tree = optimize_offsets(tree);
+	tree = optimize_dead(tree, &removed);
+
+	// Suppression de la fin non observable du programme
+	tailp = &tree;
+	for (linkp = &tree; !ast_is_empty(*linkp);
+		 linkp = &(*linkp)->little_brother)
+		if (!is_update(*linkp) && (*linkp)->type != A_LEFT
+			&& (*linkp)->type != A_RIGHT)
+			tailp = &(*linkp)->little_brother;
+	ast_free(*tailp);
+	*tailp = ast_empty();
+
+	return tree;
+}
+
+/**
+ * @brief Convertis un arbre de syntaxe abstraite d'un programme Brainfuck
+ * (simplifié par ast_minify) en programme Brainfuck minimal.
+ * 
+ * @param out Le fichier de sortie.
+ * @param tree L'arbre de syntaxe à convertir.
+ * 
+ * @note Les suites de modifications de cases sont imprimées par leur effet
+ * net, chaque ajout par la plus courte des suites équivalentes, et le
+ * pointeur n'est pas ramené à sa position finale.
+ */
+void ast_to_minified(FILE *out, Asttree tree) {
+	int pos = 0;
 
-	ast_to_brainfuck(out, tree->little_brother);
+	ast_to_brainfuck_aux(out, tree, &pos, true);
 }
 
 /**
@@ -0,0 +1,460 @@
+/**
+ * @file elf.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'écriture directe d'un exécutable ELF x86-64
+ * statique (Linux, sans libc) à partir des blocs de base d'un programme
+ * Brainfuck, sans assembleur, éditeur de liens ni compilateur C.
+ * @date 2024-05-25
+ * 
+ * 
+ */
+#include "elf.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Convention du code généré (comme en assembleur, voir ast_to_asm) :
+ * - rbx : pointeur de données (bande) ;
+ * - r12 : position dans le tampon de sortie ;
+ * - r13, r14 : position et fin du tampon d'entrée.
+ * 
+ * Le code commence par les routines d'entrée/sortie (bf_write, bf_flush,
+ * bf_putc, bf_getc), aux positions ci-dessous, suivies du programme.
+ */
+
+/**
+ * @def ELF_WRITE
+ * @brief Position de bf_write (écrit rdx octets depuis rsi) dans le code.
+ * 
+ */
+#define ELF_WRITE 0
+
+/**
+ * @def ELF_FLUSH
+ * @brief Position de bf_flush (vide le tampon de sortie) dans le code.
+ * 
+ */
+#define ELF_FLUSH 31
+
+/**
+ * @def ELF_PUTC
+ * @brief Position de bf_putc (écrit al dans le tampon de sortie) dans le
+ * code.
+ * 
+ */
+#define ELF_PUTC 47
+
+/**
+ * @def ELF_GETC
+ * @brief Position de bf_getc (lit un octet dans eax, -1 en fin de fichier)
+ * dans le code.
+ * 
+ */
+#define ELF_GETC 64
+
+/**
+ * @def ELF_RUNTIME_SIZE
+ * @brief Taille des routines d'entrée/sortie : position du programme dans le
+ * code.
+ * 
+ */
+#define ELF_RUNTIME_SIZE 121
+
+/**
+ * @def ELF_OUTBUF
+ * @brief Adresse du tampon de sortie.
+ * 
+ */
+#define ELF_OUTBUF ELF_BSS_ADDRESS
+
+/**
+ * @def ELF_INBUF
+ * @brief Adresse du tampon d'entrée.
+ * 
+ */
+#define ELF_INBUF (ELF_OUTBUF + ELF_BUFFER_LENGTH)
+
+/**
+ * @def ELF_TAPE
+ * @brief Adresse de la première case de la bande (après sa marge).
+ * 
+ */
+#define ELF_TAPE (ELF_INBUF + ELF_BUFFER_LENGTH + ELF_TAPE_MARGIN)
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+extern Options options;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/* ------------------------------- Émission --------------------------------- */
+
+/**
+ * @brief Ajoute un entier de 16 bits (petit-boutiste) à la fin d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'entier à ajouter.
+ */
+static void elf_int16(Jitbuffer *bufp, uint16_t value) {
+	JIT_EMIT(bufp, (uint8_t)value, (uint8_t)(value >> 8));
+}
+
+/**
+ * @brief Ajoute un entier de 64 bits (petit-boutiste) à la fin d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'entier à ajouter.
+ */
+static void elf_int64(Jitbuffer *bufp, uint64_t value) {
+	jit_int32(bufp, (int32_t)(uint32_t)value);
+	jit_int32(bufp, (int32_t)(uint32_t)(value >> 32));
+}
+
+/**
+ * @brief Ajoute l'appel d'une routine d'entrée/sortie ('call rel32').
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param target La position de la routine dans le code.
+ */
+static void elf_call(Jitbuffer *bufp, size_t target) {
+	JIT_EMIT(bufp, 0xE8);
+	jit_int32(bufp, (int32_t)(target - (bufp->length + 4)));
+}
+
+/* ------------------------------- Routines --------------------------------- */
+
+/**
+ * @brief Ajoute les routines d'entrée/sortie au début du code.
+ * 
+ * @param bufp Le pointeur vers le tampon (vide).
+ * 
+ * @note Les sauts internes sont courts (rel8) et précalculés : chaque routine
+ * commence à la position donnée par sa macro (ELF_WRITE, ...).
+ */
+static void elf_runtime(Jitbuffer *bufp) {
+	// bf_write : test rdx, rdx ; jle <fin> ; mov eax, 1 ; mov edi, 1 ;
+	// syscall ; test rax, rax ; jle <fin> ; add rsi, rax ; sub rdx, rax ;
+	// jmp bf_write ; <fin> : ret
+	JIT_EMIT(bufp, 0x48, 0x85, 0xD2, 0x7E, 0x19,
+			 0xB8, 0x01, 0x00, 0x00, 0x00, 0xBF, 0x01, 0x00, 0x00, 0x00,
+			 0x0F, 0x05, 0x48, 0x85, 0xC0, 0x7E, 0x08,
+			 0x48, 0x01, 0xC6, 0x48, 0x29, 0xC2, 0xEB, 0xE2, 0xC3);
+
+	// bf_flush : mov esi, outbuf ; mov rdx, r12 ; sub rdx, rsi ;
+	// mov r12, rsi ; jmp bf_write
+	JIT_EMIT(bufp, 0xBE);
+	jit_int32(bufp, ELF_OUTBUF);
+	JIT_EMIT(bufp, 0x4C, 0x89, 0xE2, 0x48, 0x29, 0xF2, 0x49, 0x89, 0xF4,
+			 0xEB, 0xD1);
+
+	// bf_putc : mov [r12], al ; inc r12 ; cmp r12, outbuf + longueur ;
+	// je bf_flush ; ret
+	JIT_EMIT(bufp, 0x41, 0x88, 0x04, 0x24, 0x49, 0xFF, 0xC4, 0x49, 0x81, 0xFC);
+	jit_int32(bufp, ELF_OUTBUF + ELF_BUFFER_LENGTH);
+	JIT_EMIT(bufp, 0x74, 0xE0, 0xC3);
+
+	// bf_getc : cmp r13, r14 ; jb <lu> ; call bf_flush ; xor eax, eax ;
+	// xor edi, edi ; mov esi, inbuf ; mov edx, longueur ; syscall ;
+	// test rax, rax ; jle <fin> ; mov r13d, inbuf ; lea r14, [r13 + rax] ;
+	// <lu> : movzx eax, byte [r13] ; inc r13 ; ret ;
+	// <fin> : mov eax, -1 ; ret
+	JIT_EMIT(bufp, 0x4D, 0x39, 0xF5, 0x72, 0x25);
+	elf_call(bufp, ELF_FLUSH);
+	JIT_EMIT(bufp, 0x31, 0xC0, 0x31, 0xFF, 0xBE);
+	jit_int32(bufp, ELF_INBUF);
+	JIT_EMIT(bufp, 0xBA);
+	jit_int32(bufp, ELF_BUFFER_LENGTH);
+	JIT_EMIT(bufp, 0x0F, 0x05, 0x48, 0x85, 0xC0, 0x7E, 0x14, 0x41, 0xBD);
+	jit_int32(bufp, ELF_INBUF);
+	JIT_EMIT(bufp, 0x4D, 0x8D, 0x74, 0x05, 0x00,
+			 0x41, 0x0F, 0xB6, 0x45, 0x00, 0x49, 0xFF, 0xC5, 0xC3,
+			 0xB8, 0xFF, 0xFF, 0xFF, 0xFF, 0xC3);
+}
+
+/* ------------------------------ Compilation ------------------------------- */
+
+/**
+ * @brief Ajoute au tampon le code machine des opérations d'un bloc de base.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param node Le bloc de base à compiler.
+ * 
+ * @note Comme en assembleur, les cases sont adressées par leur décalage
+ * depuis l'entrée du bloc, et rbx n'est déplacé qu'à la sortie du bloc.
+ */
+static void elf_block(Jitbuffer *bufp, Block *node) {
+	int size = bufp->size;
+	Blockop op;
+
+	// Les commentaires donnent les instructions pour des cases de 32 bits.
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
+
+		switch (op.op) {
+			case B_ADD:
+				// add dword [rbx + disp], imm32
+				jit_op(bufp, 0x81);
+				JIT_EMIT(bufp, 0x83);
+				jit_int32(bufp, op.offset * size);
+				jit_imm(bufp, op.arg);
+				break;
+			case B_SET:
+				// mov dword [rbx + disp], imm32
+				jit_op(bufp, 0xC7);
+				JIT_EMIT(bufp, 0x83);
+				jit_int32(bufp, op.offset * size);
+				jit_imm(bufp, op.arg);
+				break;
+			case B_PUT:
+				// mov al, [rbx + disp] ; call bf_putc
+				for (int k = 0; k < op.arg; k++) {
+					JIT_EMIT(bufp, 0x8A, 0x83);
+					jit_int32(bufp, op.offset * size);
+					elf_call(bufp, ELF_PUTC);
+				}
+				break;
+			case B_GET:
+				// call bf_getc ; mov [rbx + disp], eax
+				for (int k = 0; k < op.arg; k++) {
+					elf_call(bufp, ELF_GETC);
+					jit_op(bufp, 0x89);
+					JIT_EMIT(bufp, 0x83);
+					jit_int32(bufp, op.offset * size);
+				}
+				break;
+			case B_MUL:
+				// mov eax, [rbx + source] ; imul eax, eax, imm32 ;
+				// add [rbx + disp], eax (sub pour un facteur -1)
+				jit_load(bufp, 0x83);
+				jit_int32(bufp, op.source * size);
+				if (op.arg != 1 && op.arg != -1) {
+					JIT_EMIT(bufp, 0x69, 0xC0);
+					jit_int32(bufp, op.arg);
+				}
+				jit_op(bufp, (op.arg == -1) ? 0x29 : 0x01);
+				JIT_EMIT(bufp, 0x83);
+				jit_int32(bufp, op.offset * size);
+				break;
+			default:
+				merror("elf_block() : 'op.op' inconnu !");
+		}
+	}
+
+	// add rbx, imm32
+	if (node->shift != 0) {
+		JIT_EMIT(bufp, 0x48, 0x81, 0xC3);
+		jit_int32(bufp, node->shift * size);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute au tampon le code machine d'un programme en blocs de base.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param node Le premier noeud à compiler.
+ * 
+ * @note Une recherche de case nulle est une boucle dont le corps déplace rbx.
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+static void elf_blocks(Jitbuffer *bufp, Block *node) {
+	size_t head, body;
+
+	for (; node != NULL; node = node->next) {
+		if (node->kind == B_BASIC) {
+			elf_block(bufp, node);
+			continue;
+		}
+		if (node->kind != B_LOOP && node->kind != B_SCAN)
+			merror("elf_blocks() : 'node->kind' inconnu !");
+
+		// cmp dword [rbx], 0 ; je <fin>
+		jit_test(bufp);
+		JIT_EMIT(bufp, 0x0F, 0x84);
+		head = bufp->length;
+		jit_int32(bufp, 0);
+		body = bufp->length;
+
+		if (node->kind == B_LOOP) {
+			elf_blocks(bufp, node->body);
+		} else {
+			// add rbx, imm32
+			JIT_EMIT(bufp, 0x48, 0x81, 0xC3);
+			jit_int32(bufp, node->shift * bufp->size);
+		}
+
+		// cmp dword [rbx], 0 ; jne <corps>
+		jit_test(bufp);
+		JIT_EMIT(bufp, 0x0F, 0x85);
+		jit_int32(bufp, (int32_t)(body - (bufp->length + 4)));
+		jit_patch32(bufp, head, (int32_t)(bufp->length - body));
+	}
+}
+
+/* ------------------------------- Exécutable ------------------------------- */
+
+/**
+ * @brief Ajoute un en-tête de programme ELF64 (Elf64_Phdr) à un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param type Le type du segment (1 : PT_LOAD, 0x6474E551 : PT_GNU_STACK).
+ * @param flags Les droits du segment (4 : lecture, 2 : écriture, 1 :
+ * exécution).
+ * @param vaddr L'adresse du segment.
+ * @param filesz La taille du segment dans le fichier.
+ * @param memsz La taille du segment en mémoire (complétée par des zéros).
+ * 
+ * @note Les segments chargés commencent au début du fichier (décalage nul).
+ */
+static void elf_segment(Jitbuffer *bufp, uint32_t type, uint32_t flags,
+						uint64_t vaddr, uint64_t filesz, uint64_t memsz) {
+	jit_int32(bufp, (int32_t)type);
+	jit_int32(bufp, (int32_t)flags);
+	elf_int64(bufp, 0);							// p_offset
+	elf_int64(bufp, vaddr);						// p_vaddr
+	elf_int64(bufp, vaddr);						// p_paddr
+	elf_int64(bufp, filesz);					// p_filesz
+	elf_int64(bufp, memsz);						// p_memsz
+	elf_int64(bufp, (type == 1) ? ELF_PAGE_SIZE : 16);	// p_align
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute l'en-tête ELF64 (Elf64_Ehdr) et les en-têtes de programme à
+ * un tampon vide.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param entry L'adresse du point d'entrée.
+ * @param filesz La taille du fichier (segment de code).
+ * @param bss La taille du segment de données nulles.
+ */
+static void elf_headers(Jitbuffer *bufp, uint64_t entry, uint64_t filesz,
+						uint64_t bss) {
+	// e_ident : magique, 64 bits, petit-boutiste, version 1, System V
+	JIT_EMIT(bufp, 0x7F, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	elf_int16(bufp, 2);							// e_type : ET_EXEC
+	elf_int16(bufp, 62);						// e_machine : EM_X86_64
+	jit_int32(bufp, 1);							// e_version
+	elf_int64(bufp, entry);						// e_entry
+	elf_int64(bufp, 64);						// e_phoff
+	elf_int64(bufp, 0);							// e_shoff
+	jit_int32(bufp, 0);							// e_flags
+	elf_int16(bufp, 64);						// e_ehsize
+	elf_int16(bufp, 56);						// e_phentsize
+	elf_int16(bufp, 3);							// e_phnum
+	elf_int16(bufp, 64);						// e_shentsize
+	elf_int16(bufp, 0);							// e_shnum
+	elf_int16(bufp, 0);							// e_shstrndx
+
+	elf_segment(bufp, 1, 4 | 1, ELF_BASE_ADDRESS, filesz, filesz);
+	elf_segment(bufp, 1, 4 | 2, ELF_BSS_ADDRESS, 0, bss);
+	elf_segment(bufp, 0x6474E551, 4 | 2, 0, 0, 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit l'exécutable ELF x86-64 statique d'un programme en blocs de
+ * base sur la sortie donnée.
+ * 
+ * @param out Le fichier de sortie (ouvert en binaire).
+ * @param blocks Le programme en blocs de base (reste du programme après le
+ * préfixe évalué).
+ * @param pe Le résultat de l'évaluation partielle (sortie du préfixe, bande
+ * et position de départ).
+ * @param cells Le nombre de cases de la bande.
+ * 
+ * @note Le fichier contient les en-têtes, la sortie du préfixe, les valeurs
+ * initiales de la bande (copiées au démarrage), puis le code machine ; la
+ * bande et les tampons sont dans un segment de données nulles.
+ * @note Un exécutable dont les segments dépassent les adresses de 32 bits
+ * provoquera une erreur.
+ */
+void elf_program(FILE *out, Block *blocks, Peval pe, long cells) {
+	int size = options.cell_bits / 8;
+	long initialized = 0, start = 0;
+	uint64_t rodata = ELF_BASE_ADDRESS + ELF_HEADERS_SIZE, code, filesz;
+	Jitbuffer text = {
+		.bytes = NULL, .length = 0, .capacity = 0, .size = size,
+		.count = false
+	};
+	Jitbuffer file = text;
+
+	// État dans lequel commence le reste du programme
+	if (!ast_is_empty(pe.rest)) {
+		initialized = (pe.cells < cells) ? pe.cells : cells;
+		start = pe.ptr * size;
+	}
+	code = rodata + pe.length + initialized * size;
+
+	if ((uint64_t)ELF_TAPE + (uint64_t)cells * size > INT32_MAX)
+		merror("elf_program() : Bande de %ld cases trop grande !", cells);
+
+	elf_runtime(&text);
+
+	// mov ebx, tape + start ; mov r12d, outbuf ; xor r13d, r13d ;
+	// xor r14d, r14d
+	JIT_EMIT(&text, 0xBB);
+	jit_int32(&text, (int32_t)(ELF_TAPE + start));
+	JIT_EMIT(&text, 0x41, 0xBC);
+	jit_int32(&text, ELF_OUTBUF);
+	JIT_EMIT(&text, 0x45, 0x31, 0xED, 0x45, 0x31, 0xF6);
+
+	// Bande initialisée : mov esi, valeurs ; mov edi, tape ;
+	// mov ecx, octets ; rep movsb
+	if (initialized > 0) {
+		JIT_EMIT(&text, 0xBE);
+		jit_int32(&text, (int32_t)(rodata + pe.length));
+		JIT_EMIT(&text, 0xBF);
+		jit_int32(&text, ELF_TAPE);
+		JIT_EMIT(&text, 0xB9);
+		jit_int32(&text, (int32_t)(initialized * size));
+		JIT_EMIT(&text, 0xF3, 0xA4);
+	}
+
+	// Sortie du préfixe : mov esi, sortie ; mov edx, longueur ; call bf_write
+	if (pe.length > 0) {
+		JIT_EMIT(&text, 0xBE);
+		jit_int32(&text, (int32_t)rodata);
+		JIT_EMIT(&text, 0xBA);
+		jit_int32(&text, (int32_t)pe.length);
+		elf_call(&text, ELF_WRITE);
+	}
+
+	elf_blocks(&text, blocks);
+
+	// call bf_flush ; mov eax, 60 ; xor edi, edi ; syscall
+	elf_call(&text, ELF_FLUSH);
+	JIT_EMIT(&text, 0xB8, 0x3C, 0x00, 0x00, 0x00, 0x31, 0xFF, 0x0F, 0x05);
+
+	filesz = code - ELF_BASE_ADDRESS + text.length;
+	if (ELF_BASE_ADDRESS + filesz > ELF_BSS_ADDRESS)
+		merror("elf_program() : Code de %zu octets trop grand !", text.length);
+
+	// Fichier : en-têtes, sortie du préfixe, bande initiale, code
+	elf_headers(&file, code + ELF_RUNTIME_SIZE, filesz,
+				ELF_TAPE - ELF_BSS_ADDRESS + (uint64_t)cells * size);
+	for (long i = 0; i < pe.length; i++)
+		JIT_EMIT(&file, (uint8_t)pe.output[i]);
+	for (long i = 0; i < initialized; i++)
+		for (int b = 0; b < size; b++)
+			JIT_EMIT(&file, (uint8_t)(pe.tape[i] >> (8 * b)));
+	jit_bytes(&file, text.bytes, text.length);
+
+	if (fwrite(file.bytes, 1, file.length, out) != file.length)
+		merror("elf_program() : Échec de l'écriture de l'exécutable ! [%s]",
+			   strerror(errno));
+
+	free(text.bytes);
+	free(file.bytes);
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,293 @@
+/**
+ * @file flat.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la représentation linéaire (bytecode plat) d'un
+ * programme Brainfuck, obtenue par abaissement de sa représentation en blocs
+ * de base.
+ * @date 2024-05-02
+ * 
+ * 
+ */
+#include "flat.h"
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+extern Options options;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne un programme linéaire vide.
+ * 
+ * @return Flatprog Un programme linéaire vide.
+ */
+Flatprog flat_empty() {
+	return FLAT_EMPTY;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute une instruction à la fin d'un programme linéaire et retourne
+ * son indice.
+ * 
+ * @param progp Le pointeur vers le programme qui reçoit l'instruction.
+ * @param op Le code d'opération de l'instruction.
+ * @param arg L'argument de l'instruction.
+ * @param offset Le décalage de la case visée par l'instruction.
+ * @param node La boucle de l'arbre dont est issu un saut (NULL sinon).
+ * @return int L'indice de l'instruction ajoutée.
+ * 
+ * @note Le tableau d'instructions est agrandi (doublé) si nécessaire.
+ */
+static int flat_emit(Flatprog *progp, int op, int arg, int offset,
+					 Asttree node) {
+	Flatinst *code;
+	Asttree *nodes;
+	int capacity;
+
+	if (progp->length == progp->capacity) {
+		capacity = (progp->capacity == 0) ? FLAT_INITIAL_CAPACITY
+										  : 2 * progp->capacity;
+		code = (Flatinst *)realloc(progp->code, capacity * sizeof(Flatinst));
+		if (code == NULL)
+			merror("flat_emit() : Échec de l'allocation de mémoire à 'code' !"
+				   " [%s]", strerror(errno));
+
+		progp->code = code;
+
+		nodes = (Asttree *)realloc(progp->nodes, capacity * sizeof(Asttree));
+		if (nodes == NULL)
+			merror("flat_emit() : Échec de l'allocation de mémoire à 'nodes' !"
+				   " [%s]", strerror(errno));
+
+		progp->nodes = nodes;
+		progp->capacity = capacity;
+	}
+
+	progp->code[progp->length] = (Flatinst){
+		.op = op, .arg = arg, .offset = offset
+	};
+	progp->nodes[progp->length] = node;
+
+	return progp->length++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute au programme linéaire le vecteur de constantes d'une suite
+ * vectorielle (voir block_run) et retourne son indice.
+ * 
+ * @param progp Le pointeur vers le programme qui reçoit le vecteur.
+ * @param ops Les opérations de la suite.
+ * @param length Le nombre d'opérations de la suite.
+ * @param low Le plus petit décalage de la suite.
+ * @return int L'indice du vecteur ajouté.
+ * 
+ * @note Les constantes sont rangées avec la largeur des cases : la VM les
+ * ajoute (ou les copie) telles quelles.
+ */
+static int flat_vector(Flatprog *progp, Blockop *ops, int length, int low) {
+	int size = options.cell_bits / 8;
+	Flatvec *vectors, vector = { .values = NULL, .length = length };
+	bool zero = true;
+	uint32_t value;
+	int index;
+
+	for (int k = 0; k < length; k++)
+		if (ops[k].op == B_ADD || ops[k].arg != 0) zero = false;
+
+	if (!zero) {
+		vector.values = malloc(length * size);
+		if (vector.values == NULL)
+			merror("flat_vector() : Échec de l'allocation de mémoire à"
+				   " 'values' ! [%s]", strerror(errno));
+
+		for (int k = 0; k < length; k++) {
+			value = (uint32_t)ops[k].arg;
+			index = ops[k].offset - low;
+
+			switch (size) {
+				case 1:  ((uint8_t *)vector.values)[index] = value;  break;
+				case 2:  ((uint16_t *)vector.values)[index] = value; break;
+				default: ((uint32_t *)vector.values)[index] = value;
+			}
+		}
+	}
+
+	vectors = (Flatvec *)realloc(progp->vectors,
+								 (progp->nvectors + 1) * sizeof(Flatvec));
+	if (vectors == NULL)
+		merror("flat_vector() : Échec de l'allocation de mémoire à 'vectors'"
+			   " ! [%s]", strerror(errno));
+
+	progp->vectors = vectors;
+	progp->vectors[progp->nvectors] = vector;
+
+	return progp->nvectors++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Abaisse les opérations d'un bloc de base à la fin du programme
+ * linéaire donné.
+ * 
+ * @param progp Le pointeur vers le programme qui reçoit les instructions.
+ * @param node Le bloc de base à abaisser.
+ * 
+ * @note Le pointeur n'est déplacé qu'avant une multiplication (F_MUL lit la
+ * case pointée) et à la sortie du bloc : 'pos' est sa position courante,
+ * relative à l'entrée du bloc.
+ * @note Une suite vectorielle (voir block_run) devient une seule instruction
+ * F_VADD ou F_VSET.
+ */
+static void flat_basic(Flatprog *progp, Block *node) {
+	int pos = 0, run, low, index;
+	Blockop op;
+
+	for (int i = 0; i < node->length; i++) {
+		op = node->ops[i];
+
+		if ((run = block_run(node, i)) > 0) {
+			low = (op.offset < node->ops[i + run - 1].offset)
+				  ? op.offset : node->ops[i + run - 1].offset;
+			index = flat_vector(progp, node->ops + i, run, low);
+			flat_emit(progp, (op.op == B_ADD) ? F_VADD : F_VSET, index,
+					  low - pos, NULL);
+			i += run - 1;
+			continue;
+		}
+
+		switch (op.op) {
+			case B_ADD:
+				flat_emit(progp, F_ADD, op.arg, op.offset - pos, NULL);
+				break;
+			case B_SET:
+				flat_emit(progp, F_CLEAR, op.arg, op.offset - pos, NULL);
+				break;
+			case B_PUT:
+				flat_emit(progp, F_PUT, op.arg, op.offset - pos, NULL);
+				break;
+			case B_GET:
+				flat_emit(progp, F_GET, op.arg, op.offset - pos, NULL);
+				break;
+			case B_MUL:
+				if (op.source != pos)
+					flat_emit(progp, F_MOVE, op.source - pos, 0, NULL);
+				pos = op.source;
+				flat_emit(progp, F_MUL, op.arg, op.offset - pos, NULL);
+				break;
+			default:
+				merror("flat_basic() : 'op.op' inconnu !");
+		}
+	}
+
+	if (node->shift != pos)
+		flat_emit(progp, F_MOVE, node->shift - pos, 0, NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fonction auxiliaire à flat.
+ * 
+ * Abaisse le noeud donné (ainsi que tous ceux qui le suivent) à la fin du
+ * programme linéaire donné.
+ * 
+ * @param progp Le pointeur vers le programme qui reçoit les instructions.
+ * @param node Le premier noeud à abaisser.
+ * 
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ * @note La récursion ne porte que sur les corps de boucles : la profondeur
+ * d'appel est bornée par la profondeur d'imbrication des boucles.
+ */
+static void flat_aux(Flatprog *progp, Block *node) {
+	int open, close;
+
+	for (; node != NULL; node = node->next) {
+		switch (node->kind) {
+			case B_BASIC:
+				flat_basic(progp, node);
+				break;
+			case B_LOOP:
+				// Décalages extrêmes de la boucle (voir bounds.h).
+				open = flat_emit(progp, F_JZ, -1, node->node->id_lex,
+								 node->node);
+				flat_aux(progp, node->body);
+				// flat_emit peut déplacer 'code' : l'index est lu d'abord.
+				close = flat_emit(progp, F_JNZ, open, node->node->id_symb,
+								  node->node);
+				progp->code[open].arg = close;
+				break;
+			case B_SCAN:
+				flat_emit(progp, F_SCAN, node->shift, 0, NULL);
+				break;
+			default:
+				merror("flat_aux() : 'node->kind' inconnu !");
+		}
+	}
+}
+
+/**
+ * @brief Abaisse un programme en blocs de base en programme linéaire.
+ * 
+ * @param prog Le premier noeud du programme en blocs de base.
+ * @return Flatprog Le programme linéaire correspondant, terminé par F_END.
+ * 
+ * @note Une sorte de noeud inconnue provoquera une erreur.
+ */
+Flatprog flat(Block *prog) {
+	Flatprog flatprog = flat_empty();
+
+	flat_aux(&flatprog, prog);
+	flat_emit(&flatprog, F_END, 0, 0, NULL);
+
+	return flatprog;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un programme linéaire.
+ * 
+ * @param progp Le pointeur vers le programme à libérer.
+ */
+void flat_free(Flatprog *progp) {
+	if (progp == NULL) return;
+
+	free(progp->code);
+	free(progp->nodes);
+	for (int k = 0; k < progp->nvectors; k++) free(progp->vectors[k].values);
+	free(progp->vectors);
+	*progp = flat_empty();
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime un programme linéaire sur la sortie spécifiée sous un format
+ * lisible pour l'oeil humain.
+ * 
+ * @param prog Le programme à imprimer.
+ * @param out La sortie sur laquelle imprimer le programme (Par défaut, stdout).
+ */
+void flat_print(Flatprog prog, FILE *out) {
+	char *ops[] = FLAT_OPS_STRINGS;
+
+	if (out == NULL) out = stdout;
+
+	for (int i = 0; i < prog.length; i++)
+		fprintf(out, "%6d  %-14s %d @%d\n", i, ops[prog.code[i].op],
+				prog.code[i].arg, prog.code[i].offset);
+	for (int k = 0; k < prog.nvectors; k++)
+		fprintf(out, "vecteur %d : %d case(s)%s\n", k, prog.vectors[k].length,
+				(prog.vectors[k].values == NULL) ? ", nulles" : "");
+}
+
+/* -------------------------------------------------------------------------- */
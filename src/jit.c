@@ -0,0 +1,479 @@
+/**
+ * @file jit.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la compilation à la volée (JIT) d'un arbre de
+ * syntaxe abstraite (AST) Brainfuck en code machine x86-64.
+ * @date 2024-05-11
+ * 
+ * 
+ */
+#define _DEFAULT_SOURCE
+#include "jit.h"
+#include "scan.h"
+
+#if JIT_AVAILABLE
+#include <sys/mman.h>
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Convention du code généré (System V AMD64) :
+ * - rbx : pointeur de données (bande) ;
+ * - r12 : adresse de l'environnement d'exécution (Jitruntime) ;
+ * - rbp : sauvegardé uniquement pour aligner la pile sur 16 octets.
+ */
+
+/**
+ * @def JIT_RT_PUT
+ * @brief Décalage du champ 'put' dans la structure Jitruntime.
+ * 
+ */
+#define JIT_RT_PUT  0
+
+/**
+ * @def JIT_RT_GET
+ * @brief Décalage du champ 'get' dans la structure Jitruntime.
+ * 
+ */
+#define JIT_RT_GET  8
+
+/**
+ * @def JIT_RT_SCAN
+ * @brief Décalage du champ 'scan' dans la structure Jitruntime.
+ * 
+ */
+#define JIT_RT_SCAN 16
+
+/**
+ * @def JIT_RT_ITERATIONS
+ * @brief Décalage du champ 'iterations' dans la structure Jitruntime.
+ * 
+ */
+#define JIT_RT_ITERATIONS 24
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/* ----------------------------- Environnement ------------------------------ */
+
+/**
+ * @brief Affiche 'count' fois la valeur donnée (appelée par le code machine).
+ * 
+ * @param value La valeur à afficher.
+ * @param count Le nombre d'affichages.
+ */
+static void jit_put(int value, int count) {
+	for (int i = 0; i < count; i++)
+		putchar(value);
+}
+
+/**
+ * @brief Lit 'count' entrées et retourne la dernière (appelée par le code
+ * machine).
+ * 
+ * @param count Le nombre de lectures.
+ * @return int La dernière valeur lue.
+ */
+static int jit_get(int count) {
+	int value = 0;
+
+	for (int i = 0; i < count; i++)
+		value = getchar();
+
+	EMPTY_BUFFER();
+	return value;
+}
+
+/* ------------------------------- Émission --------------------------------- */
+
+/**
+ * @brief Ajoute des octets à la fin d'un tampon de code machine.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param bytes Les octets à ajouter.
+ * @param count Le nombre d'octets à ajouter.
+ * 
+ * @note Le tampon est agrandi (doublé) si nécessaire.
+ */
+void jit_bytes(Jitbuffer *bufp, const uint8_t *bytes, size_t count) {
+	uint8_t *grown;
+	size_t capacity;
+
+	if (bufp->length + count > bufp->capacity) {
+		capacity = (bufp->capacity == 0) ? JIT_INITIAL_CAPACITY
+										 : bufp->capacity;
+		while (capacity < bufp->length + count) capacity *= 2;
+
+		grown = (uint8_t *)realloc(bufp->bytes, capacity);
+		if (grown == NULL)
+			merror("jit_bytes() : Échec de l'allocation de mémoire à 'bytes' !"
+				   " [%s]", strerror(errno));
+
+		bufp->bytes = grown;
+		bufp->capacity = capacity;
+	}
+
+	memcpy(bufp->bytes + bufp->length, bytes, count);
+	bufp->length += count;
+}
+
+/**
+ * @brief Ajoute un entier de 32 bits (petit-boutiste) à la fin d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'entier à ajouter.
+ */
+void jit_int32(Jitbuffer *bufp, int32_t value) {
+	uint8_t bytes[4];
+	uint32_t u = (uint32_t)value;
+
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (uint8_t)(u >> (8 * i));
+
+	jit_bytes(bufp, bytes, 4);
+}
+
+/**
+ * @brief Réécrit un entier de 32 bits (petit-boutiste) à une position donnée
+ * d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param at La position de l'entier.
+ * @param value L'entier à écrire.
+ */
+void jit_patch32(Jitbuffer *bufp, size_t at, int32_t value) {
+	uint32_t u = (uint32_t)value;
+
+	for (int i = 0; i < 4; i++)
+		bufp->bytes[at + i] = (uint8_t)(u >> (8 * i));
+}
+
+/**
+ * @brief Ajoute un immédiat de la taille d'une case (petit-boutiste) à la fin
+ * d'un tampon.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param value L'immédiat à ajouter (tronqué à la taille d'une case).
+ */
+void jit_imm(Jitbuffer *bufp, int32_t value) {
+	uint8_t bytes[4];
+	uint32_t u = (uint32_t)value;
+
+	for (int i = 0; i < bufp->size; i++)
+		bytes[i] = (uint8_t)(u >> (8 * i));
+
+	jit_bytes(bufp, bytes, bufp->size);
+}
+
+/**
+ * @brief Ajoute le code d'opération d'une instruction portant sur une case.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param op Le code d'opération 32 bits (81, 89, C7, 01, ...), dont la
+ * variante 8 bits est le code précédent et la variante 16 bits est préfixée
+ * par 66.
+ */
+void jit_op(Jitbuffer *bufp, uint8_t op) {
+	if (bufp->size == 2) JIT_EMIT(bufp, 0x66);
+	JIT_EMIT(bufp, (bufp->size == 1) ? op - 1 : op);
+}
+
+/**
+ * @brief Ajoute le chargement (avec extension par des zéros) d'une case dans
+ * un registre de 32 bits.
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param modrm L'octet ModR/M désignant le registre et la case.
+ */
+void jit_load(Jitbuffer *bufp, uint8_t modrm) {
+	switch (bufp->size) {
+		case 1:  JIT_EMIT(bufp, 0x0F, 0xB6, modrm); break; // movzx r32, byte
+		case 2:  JIT_EMIT(bufp, 0x0F, 0xB7, modrm); break; // movzx r32, word
+		default: JIT_EMIT(bufp, 0x8B, modrm);			  // mov r32, dword
+	}
+}
+
+/**
+ * @brief Ajoute le test à zéro de la case pointée ('cmp [rbx], 0').
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ */
+void jit_test(Jitbuffer *bufp) {
+	if (bufp->size == 1) {
+		JIT_EMIT(bufp, 0x80, 0x3B, 0x00);
+		return;
+	}
+
+	if (bufp->size == 2) JIT_EMIT(bufp, 0x66);
+	JIT_EMIT(bufp, 0x83, 0x3B, 0x00);
+}
+
+/* ------------------------------ Compilation ------------------------------- */
+
+static void jit_aux(Jitbuffer *bufp, Asttree tree);
+
+/**
+ * @brief Ajoute au tampon le code machine d'un seul noeud de l'arbre (sans ses
+ * petits-frères).
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param tree Le noeud à compiler.
+ * 
+ * @note Un type d'arbre inconnu provoquera une erreur.
+ */
+static void jit_node(Jitbuffer *bufp, Asttree tree) {
+	int count, disp;
+	size_t head, body;
+
+	count = tree->id_lex;
+	disp = tree->id_symb * bufp->size;
+
+	// Les commentaires donnent les instructions pour des cases de 32 bits.
+	switch (tree->type) {
+		case A_LOOP:
+			// cmp dword [rbx], 0 ; je <fin>
+			jit_test(bufp);
+			JIT_EMIT(bufp, 0x0F, 0x84);
+			head = bufp->length;
+			jit_int32(bufp, 0);
+			body = bufp->length;
+
+			// inc qword [r12 + iterations]
+			if (bufp->count)
+				JIT_EMIT(bufp, 0x49, 0xFF, 0x44, 0x24, JIT_RT_ITERATIONS);
+
+			jit_aux(bufp, tree->son);
+
+			// cmp dword [rbx], 0 ; jne <corps>
+			jit_test(bufp);
+			JIT_EMIT(bufp, 0x0F, 0x85);
+			jit_int32(bufp, (int32_t)(body - (bufp->length + 4)));
+			jit_patch32(bufp, head, (int32_t)(bufp->length - body));
+			break;
+		case A_INC:
+		case A_DEC:
+			// add dword [rbx + disp], imm32
+			jit_op(bufp, 0x81);
+			JIT_EMIT(bufp, 0x83);
+			jit_int32(bufp, disp);
+			jit_imm(bufp, (tree->type == A_INC) ? count : -count);
+			break;
+		case A_RIGHT:
+		case A_LEFT:
+			// add rbx, imm32
+			JIT_EMIT(bufp, 0x48, 0x81, 0xC3);
+			jit_int32(bufp, bufp->size *
+					  ((tree->type == A_RIGHT) ? count : -count));
+			break;
+		case A_PUT:
+			// mov edi, [rbx + disp] ; mov esi, imm32 ; call [r12 + put]
+			jit_load(bufp, 0xBB);
+			jit_int32(bufp, disp);
+			JIT_EMIT(bufp, 0xBE);
+			jit_int32(bufp, count);
+			JIT_EMIT(bufp, 0x41, 0xFF, 0x54, 0x24, JIT_RT_PUT);
+			break;
+		case A_GET:
+			// mov edi, imm32 ; call [r12 + get] ; mov [rbx + disp], eax
+			JIT_EMIT(bufp, 0xBF);
+			jit_int32(bufp, count);
+			JIT_EMIT(bufp, 0x41, 0xFF, 0x54, 0x24, JIT_RT_GET);
+			jit_op(bufp, 0x89);
+			JIT_EMIT(bufp, 0x83);
+			jit_int32(bufp, disp);
+			break;
+		case A_CLEAR:
+			// mov dword [rbx + disp], 0
+			jit_op(bufp, 0xC7);
+			JIT_EMIT(bufp, 0x83);
+			jit_int32(bufp, disp);
+			jit_imm(bufp, 0);
+			break;
+		case A_SCAN:
+			// mov rdi, rbx ; mov esi, imm32 ; mov edx, imm32 ;
+			// call [r12 + scan] ; mov rbx, rax
+			JIT_EMIT(bufp, 0x48, 0x89, 0xDF, 0xBE);
+			jit_int32(bufp, count);
+			JIT_EMIT(bufp, 0xBA);
+			jit_int32(bufp, bufp->size);
+			JIT_EMIT(bufp, 0x41, 0xFF, 0x54, 0x24, JIT_RT_SCAN);
+			JIT_EMIT(bufp, 0x48, 0x89, 0xC3);
+			break;
+		case A_MUL:
+			// mov eax, [rbx] ; imul eax, eax, imm32 ; add [rbx + disp], eax
+			// Une case à gauche pouvant précéder la bande, elle est alors
+			// remplacée sans saut par la case pointée lorsque celle-ci est
+			// nulle (voir execute_instruction) :
+			// lea rcx, [rbx + disp] ; test eax, eax ; cmovz rcx, rbx ;
+			// ... ; add [rcx], eax
+			jit_load(bufp, 0x03);
+			if (disp < 0) {
+				JIT_EMIT(bufp, 0x48, 0x8D, 0x8B);
+				jit_int32(bufp, disp);
+				JIT_EMIT(bufp, 0x85, 0xC0, 0x48, 0x0F, 0x44, 0xCB);
+			}
+			JIT_EMIT(bufp, 0x69, 0xC0);
+			jit_int32(bufp, count);
+			jit_op(bufp, 0x01);
+			if (disp < 0) {
+				JIT_EMIT(bufp, 0x01);
+			} else {
+				JIT_EMIT(bufp, 0x83);
+				jit_int32(bufp, disp);
+			}
+			break;
+		default:
+			merror("jit_node() : 'tree->type' inconnu !");
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute au tampon le code machine de l'arbre donné (ainsi que de tous
+ * ses petits-frères).
+ * 
+ * @param bufp Le pointeur vers le tampon.
+ * @param tree L'arbre à compiler.
+ */
+static void jit_aux(Jitbuffer *bufp, Asttree tree) {
+	for (; !ast_is_empty(tree); tree = tree->little_brother)
+		jit_node(bufp, tree);
+}
+
+/**
+ * @brief Compile un arbre (seul ou avec ses petits-frères) en code machine
+ * exécutable.
+ * 
+ * @param tree L'arbre à compiler.
+ * @param brothers Vaut true si les petits-frères de l'arbre sont compilés.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @param count Vaut true si les itérations des boucles sont comptées.
+ * @return Jitcode Le code machine exécutable correspondant.
+ */
+static Jitcode jit_build(Asttree tree, bool brothers, int size, bool count) {
+	Jitcode code = JIT_EMPTY;
+#if JIT_AVAILABLE
+	Jitbuffer buf = {
+		.bytes = NULL, .length = 0, .capacity = 0,
+		.size = size, .count = count
+	};
+
+	// Prologue : push rbx ; push r12 ; push rbp ; mov rbx, rdi ; mov r12, rsi
+	JIT_EMIT(&buf, 0x53, 0x41, 0x54, 0x55, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4);
+
+	if (brothers) jit_aux(&buf, tree);
+	else if (!ast_is_empty(tree)) jit_node(&buf, tree);
+
+	// Épilogue : mov rax, rbx ; pop rbp ; pop r12 ; pop rbx ; ret
+	JIT_EMIT(&buf, 0x48, 0x89, 0xD8, 0x5D, 0x41, 0x5C, 0x5B, 0xC3);
+
+	// Copie dans une zone inscriptible, puis passage en lecture/exécution.
+	code.size = buf.length;
+	code.code = mmap(NULL, code.size, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (code.code == MAP_FAILED)
+		merror("jit() : Échec de l'allocation de la zone de code ! [%s]",
+			   strerror(errno));
+
+	memcpy(code.code, buf.bytes, buf.length);
+	free(buf.bytes);
+
+	if (mprotect(code.code, code.size, PROT_READ | PROT_EXEC) != 0)
+		merror("jit() : Échec de la protection de la zone de code ! [%s]",
+			   strerror(errno));
+#else
+	(void)tree;
+	(void)brothers;
+	(void)size;
+	(void)count;
+#endif
+
+	return code;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compile un arbre de syntaxe abstraite (AST) en code machine x86-64.
+ * 
+ * @param tree L'arbre à compiler.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return Jitcode Le code machine exécutable correspondant.
+ * 
+ * @note Un type d'arbre inconnu ou un échec d'allocation de la zone mémoire
+ * provoquera une erreur.
+ * @note Si JIT_AVAILABLE vaut 0, un code vide est retourné.
+ */
+Jitcode jit(Asttree tree, int size) {
+	return jit_build(tree, true, size, false);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compile une seule boucle (sans ses petits-frères) en code machine
+ * x86-64.
+ * 
+ * @param loop La boucle (A_LOOP) à compiler.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @param count Vaut true si les itérations des boucles doivent être comptées
+ * (voir jit_run).
+ * @return Jitcode Le code machine exécutable correspondant.
+ * 
+ * @note Le code peut être exécuté au début de n'importe quelle itération de la
+ * boucle : il reprend au test de la case pointée.
+ */
+Jitcode jit_loop(Asttree loop, int size, bool count) {
+	return jit_build(loop, false, size, count);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute un code machine sur la bande de données donnée.
+ * 
+ * @param code Le code machine à exécuter.
+ * @param tape La case de départ de la bande de données.
+ * @param iterations Si non NULL, reçoit en plus le nombre d'itérations de
+ * boucles exécutées (code compilé avec comptage uniquement).
+ * @return void* La case pointée à la fin de l'exécution.
+ */
+void *jit_run(Jitcode code, void *tape, long *iterations) {
+	Jitruntime runtime = {
+		.put = jit_put, .get = jit_get, .scan = scan_zero, .iterations = 0
+	};
+	void *(*entry)(void *, Jitruntime *);
+
+	if (code.code == NULL) return tape;
+
+	// Conversion passant par memcpy : le C ISO ne permet pas de convertir un
+	// pointeur de données en pointeur de fonction.
+	memcpy(&entry, &code.code, sizeof(entry));
+	tape = entry(tape, &runtime);
+
+	if (iterations != NULL) *iterations += runtime.iterations;
+	return tape;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à un code machine.
+ * 
+ * @param codep Le pointeur vers le code à libérer.
+ */
+void jit_free(Jitcode *codep) {
+	if (codep == NULL || codep->code == NULL) return;
+
+#if JIT_AVAILABLE
+	munmap(codep->code, codep->size);
+#endif
+	*codep = JIT_EMPTY;
+}
+
+/* -------------------------------------------------------------------------- */
\ No newline at end of file
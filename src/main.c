@@ -3,6 +3,7 @@
 #include "compiler.h"
 #include "decompiler.h"
 #include "vm.h"
+#include "optimizer.h"
 #include "parser_ast.tab.h"
 #include "parser_code.tab.h"
 
@@ -27,10 +28,148 @@ extern int aalex_destroy(void);
  */
 Asttree prog_tree;
 
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @var Options options
+ * @brief Variable permettant de stocker les drapeaux passés au programme.
+ * 
+ */
+Options options;
+
 /* -------------------------------------------------------------------------- */
 /*                                    MAIN                                    */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Récupère les drapeaux présents dans les arguments d'appel et les
+ * retire de ces derniers.
+ * 
+ * @param argc Le nombre d'arguments.
+ * @param argv Les arguments.
+ * @return int Le nombre d'arguments restants.
+ * 
+ * @see Options
+ */
+int flags(int argc, char *argv[]) {
+	size_t tiered = strlen(FLAG_TIERED), bits = strlen(FLAG_CELL_BITS);
+	size_t record = strlen(FLAG_PROFILE_RECORD);
+	size_t fuse = strlen(FLAG_PROFILE_FUSE), partial = strlen(FLAG_PEVAL);
+	size_t unroll = strlen(FLAG_UNROLL), level = strlen(FLAG_OPT_LEVEL);
+	char *end;
+	int kept = 1;
+
+	options.cell_bits = CELL_DEFAULT_BITS;
+	options.unroll = OPT_UNROLL_DEFAULT;
+	options.opt_level = OPT_DEFAULT_LEVEL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], FLAG_TREE_WALKER) == 0) {
+			options.tree_walker = true;
+			continue;
+		}
+		if (strcmp(argv[i], FLAG_JIT) == 0) {
+			options.jit = true;
+			continue;
+		}
+		if (strcmp(argv[i], FLAG_STATS) == 0) {
+			options.stats = true;
+			continue;
+		}
+		if (strcmp(argv[i], FLAG_SPARSE) == 0) {
+			options.sparse = true;
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_TIERED, tiered) == 0) {
+			options.tier_threshold = TIER_DEFAULT_THRESHOLD;
+			if (argv[i][tiered] != '\0')
+				options.tier_threshold = strtol(argv[i] + tiered, &end, 10);
+
+			if (argv[i][tiered] != '\0'
+				&& (*end != '\0' || options.tier_threshold <= 0)) {
+				usage(argv[0], "Le seuil [%s] est incorrect !",
+					  argv[i] + tiered);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_PEVAL, partial) == 0) {
+			options.peval_budget = PEVAL_DEFAULT_BUDGET;
+			if (argv[i][partial] != '\0')
+				options.peval_budget = strtol(argv[i] + partial, &end, 10);
+
+			if (argv[i][partial] != '\0'
+				&& (*end != '\0' || options.peval_budget <= 0)) {
+				usage(argv[0], "Le budget [%s] est incorrect !",
+					  argv[i] + partial);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_OPT_LEVEL, level) == 0) {
+			options.opt_level = (int)strtol(argv[i] + level, &end, 10);
+
+			if (argv[i][level] == '\0' || *end != '\0'
+				|| options.opt_level < 0
+				|| options.opt_level > OPT_MAX_LEVEL) {
+				usage(argv[0], "Le niveau d'optimisation [%s] est incorrect !",
+					  argv[i] + level);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_UNROLL, unroll) == 0) {
+			options.unroll = (int)strtol(argv[i] + unroll, &end, 10);
+
+			if (*end != '\0' || options.unroll <= 0) {
+				usage(argv[0], "Le facteur de déroulage [%s] est incorrect !",
+					  argv[i] + unroll);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_CELL_BITS, bits) == 0) {
+			options.cell_bits = (int)strtol(argv[i] + bits, &end, 10);
+
+			if (*end != '\0' || (options.cell_bits != 8
+				&& options.cell_bits != 16 && options.cell_bits != 32)) {
+				usage(argv[0], "La largeur de case [%s] est incorrecte !",
+					  argv[i] + bits);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+
+		if (strncmp(argv[i], FLAG_PROFILE_RECORD, record) == 0) {
+			options.profile_out = argv[i] + record;
+
+			if (*options.profile_out == '\0') {
+				usage(argv[0], "Le drapeau [%s] attend un chemin de profil !",
+					  argv[i]);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (strncmp(argv[i], FLAG_PROFILE_FUSE, fuse) == 0) {
+			options.profile_in = argv[i] + fuse;
+
+			if (*options.profile_in == '\0') {
+				usage(argv[0], "Le drapeau [%s] attend un chemin de profil !",
+					  argv[i]);
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+
+		argv[kept++] = argv[i];
+	}
+	argv[kept] = NULL;
+
+	return kept;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * @brief Récupère le mode d'exécution du programme à partir des arguments
  * d'appel.
@@ -49,6 +188,7 @@ int mode(int argc, char *argv[]) {
 			return MODE_HELP;
 		case 2: 
 			if (strcmp(argv[1], "-h") == 0) 	mode = MODE_HELP;
+			if (strcmp(argv[1], "-v") == 0) 	mode = MODE_INFO;
 			break;
 		case 3:
 			if (strcmp(argv[1], "-i") == 0) 	mode = MODE_INTERPRET;
@@ -85,8 +225,12 @@ void exec(int mode, int argc, char *argv[]) {
 		case MODE_HELP:
 			usage(argv[0], "");
 			break;
+		case MODE_INFO:
+			vm_info(stdout);
+			break;
 		case MODE_INTERPRET:
 			parse(argv[2], &ccin, ccparse, cclex_destroy);
+			prog_tree = optimize(prog_tree);
 			execute_program(prog_tree);
 			break;
 		case MODE_COMPILE:
@@ -97,6 +241,7 @@ void exec(int mode, int argc, char *argv[]) {
 			break;
 		case MODE_VM:
 			parse(argv[2], &aain, aaparse, aalex_destroy);
+			prog_tree = optimize(prog_tree);
 			execute_program(prog_tree);
 			break;
 		default:
@@ -118,6 +263,7 @@ void exec(int mode, int argc, char *argv[]) {
 int main(int argc, char *argv[]) {
 	int m;
 
+	argc = flags(argc, argv);
 	m = mode(argc, argv);
 	exec(m, argc, argv);
 
@@ -0,0 +1,1168 @@
+/**
+ * @file optimizer.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant les passes d'optimisation appliquées à l'arbre de
+ * syntaxe abstraite (AST) d'un programme Brainfuck.
+ * @date 2024-05-04
+ * 
+ * 
+ */
+#include "optimizer.h"
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+extern Options options;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne un noeud sans fils ni petit-frère.
+ * 
+ * @param type Le type du noeud.
+ * @param id_lex Le numéro lexicographique du noeud.
+ * @param id_symb Le numéro de symbole du noeud.
+ * @return Asttree Le noeud créé.
+ */
+static Asttree opt_node(int type, int id_lex, int id_symb) {
+	return ast(ASTDATA_TYPE_TREE, type, id_lex, id_symb, ast_empty(),
+			   ast_empty());
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute un noeud à la fin d'une chaîne de petits-frères en cours de
+ * construction et retourne le nouvel emplacement de fin de chaîne.
+ * 
+ * @param tailp L'emplacement de fin de chaîne.
+ * @param node Le noeud à ajouter.
+ * @return Asttree* Le nouvel emplacement de fin de chaîne.
+ */
+static Asttree *opt_append(Asttree *tailp, Asttree node) {
+	*tailp = node;
+	return &node->little_brother;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nombre de noeuds d'un arbre (fils et petits-frères
+ * compris).
+ * 
+ * @param tree L'arbre.
+ * @return int Le nombre de noeuds.
+ */
+static int opt_count(Asttree tree) {
+	int count = 0;
+
+	for (; !ast_is_empty(tree); tree = tree->little_brother)
+		count += 1 + opt_count(tree->son);
+
+	return count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la contribution signée d'une incrémentation, décrémentation
+ * ou d'un déplacement (sinon 0).
+ * 
+ * @param node Le noeud.
+ * @return int La valeur ajoutée à la case, ou le déplacement du pointeur.
+ */
+static int opt_signed(Asttree node) {
+	switch (node->type) {
+		case A_INC:
+		case A_RIGHT: return node->id_lex;
+		case A_DEC:
+		case A_LEFT:  return -node->id_lex;
+		default:      return 0;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fusionne un noeud avec le noeud qui le précède lorsqu'ils modifient
+ * la même case ou déplacent tous deux le pointeur ("+-", "<>", "++-", ...).
+ * 
+ * @param prev Le noeud précédent.
+ * @param node Le noeud suivant.
+ * @return int Le nombre de noeuds devenus inutiles (0 : pas de fusion, 1 :
+ * 'node' est absorbé par 'prev', 2 : ils s'annulent).
+ * 
+ * @note 'node' n'est pas libéré.
+ */
+static int opt_cancel(Asttree prev, Asttree node) {
+	bool moves = (prev->type == A_LEFT || prev->type == A_RIGHT)
+				 && (node->type == A_LEFT || node->type == A_RIGHT);
+	bool adds = (prev->type == A_INC || prev->type == A_DEC)
+				&& (node->type == A_INC || node->type == A_DEC)
+				&& prev->id_symb == node->id_symb;
+	int value;
+
+	if (!moves && !adds) return 0;
+
+	value = opt_signed(prev) + opt_signed(node);
+	if (value == 0) return 2;
+
+	if (moves) prev->type = (value > 0) ? A_RIGHT : A_LEFT;
+	else prev->type = (value > 0) ? A_INC : A_DEC;
+	prev->id_lex = abs(value);
+
+	return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fonction auxiliaire à optimize_dead : un parcours d'une chaîne de
+ * petits-frères.
+ * 
+ * @param tree La chaîne à simplifier.
+ * @param zero Vaut true si la case pointée est nulle au début de la chaîne.
+ * @param blank Vaut true si toute la bande est nulle au début de la chaîne.
+ * @param removedp Le compteur de noeuds supprimés.
+ * @return Asttree La chaîne simplifiée.
+ */
+static Asttree opt_dead(Asttree tree, bool zero, bool blank, int *removedp) {
+	Asttree *linkp = &tree, *prevp = NULL, node;
+	int cancelled;
+
+	while (!ast_is_empty(*linkp)) {
+		node = *linkp;
+
+		// Boucle, recherche ou remise à zéro d'une case déjà nulle.
+		cancelled = (zero && (node->type == A_LOOP || node->type == A_SCAN
+							  || (node->type == A_CLEAR && node->id_symb == 0)))
+					? -1 : 0;
+		if (!cancelled && prevp != NULL) cancelled = opt_cancel(*prevp, node);
+
+		if (cancelled) {
+			*linkp = node->little_brother;
+			node->little_brother = ast_empty();
+			*removedp += (cancelled < 0) ? opt_count(node) : cancelled;
+			ast_free(node);
+
+			// Les deux noeuds s'annulent : le précédent disparaît aussi.
+			if (cancelled == 2) {
+				node = *prevp;
+				*prevp = node->little_brother;
+				node->little_brother = ast_empty();
+				ast_free(node);
+				linkp = prevp;
+				prevp = NULL;
+			}
+			continue;
+		}
+
+		switch (node->type) {
+			case A_LOOP:
+				node->son = opt_dead(node->son, false, false, removedp);
+				zero = true;
+				blank = false;
+				break;
+			case A_SCAN:
+				zero = true;
+				break;
+			case A_CLEAR:
+				if (node->id_symb == 0) zero = true;
+				break;
+			case A_LEFT:
+			case A_RIGHT:
+				zero = blank;
+				break;
+			case A_PUT:
+				break;
+			default:
+				if (node->id_symb == 0) zero = false;
+				blank = false;
+		}
+
+		prevp = linkp;
+		linkp = &node->little_brother;
+	}
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Supprime le code mort et les instructions qui s'annulent.
+ * 
+ * Sont supprimés :
+ * - les boucles (et recherches) atteintes sur une case nulle : au début du
+ *   programme, où toute la bande est nulle (boucles de commentaire), ou juste
+ *   après une autre boucle, dont la case est nulle à la sortie ;
+ * - les incrémentations et décrémentations adjacentes d'une même case, et les
+ *   déplacements adjacents, qui sont fusionnés ("+-", "<>", ...).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param removedp L'emplacement qui reçoit le nombre de noeuds supprimés.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les noeuds supprimés sont
+ * libérés. Les parcours sont répétés tant qu'ils suppriment des noeuds (une
+ * annulation peut en rendre d'autres adjacentes, ou rendre une boucle morte).
+ */
+Asttree optimize_dead(Asttree tree, int *removedp) {
+	int before;
+
+	*removedp = 0;
+	do {
+		before = *removedp;
+		tree = opt_dead(tree, true, true, removedp);
+	} while (*removedp != before);
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le masque de la largeur des cases (2^n - 1).
+ * 
+ * @return uint32_t Le masque.
+ */
+static uint32_t opt_mask(void) {
+	return (uint32_t)((1ull << options.cell_bits) - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne l'inverse d'un entier impair modulo 2^32 (donc modulo 2^n
+ * pour toute largeur n).
+ * 
+ * @param c L'entier impair.
+ * @return uint32_t L'inverse de c.
+ * 
+ * @note Méthode de Newton : c est son propre inverse sur 3 bits, et chaque
+ * itération double le nombre de bits exacts.
+ */
+static uint32_t opt_inverse(uint32_t c) {
+	uint32_t inverse = c;
+
+	for (int i = 0; i < 4; i++) inverse *= 2 - c * inverse;
+
+	return inverse;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le représentant signé (le plus proche de zéro) d'une valeur
+ * modulo 2^n.
+ * 
+ * @param value La valeur.
+ * @return int Le représentant, dans [-2^(n-1), 2^(n-1)[.
+ */
+static int opt_signed_value(uint32_t value) {
+	uint32_t mask = opt_mask();
+
+	value &= mask;
+	return (value > mask / 2) ? -(int)(mask - value) - 1 : (int)value;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Vide un état symbolique.
+ * 
+ * @param st Le pointeur vers l'état.
+ * @param blank Vaut true si les cases non suivies sont nulles.
+ */
+static void opt_reset(Optstate *st, bool blank) {
+	st->length = 0;
+	st->cursor = 0;
+	st->blank = blank;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la case suivie au décalage donné, ou NULL si elle ne l'est
+ * pas.
+ * 
+ * @param st Le pointeur vers l'état.
+ * @param offset Le décalage de la case.
+ * @return Cellstate* La case, ou NULL.
+ */
+static Cellstate *opt_find(Optstate *st, int offset) {
+	for (int i = 0; i < st->length; i++)
+		if (st->cells[i].offset == offset) return &st->cells[i];
+
+	return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la case au décalage donné, en commençant à la suivre au
+ * besoin (nulle si les cases non suivies le sont, inconnue sinon).
+ * 
+ * @param st Le pointeur vers l'état.
+ * @param offset Le décalage de la case.
+ * @return Cellstate* La case, ou NULL si l'état suit déjà OPT_MAX_CELLS cases.
+ */
+static Cellstate *opt_cell(Optstate *st, int offset) {
+	Cellstate *cell = opt_find(st, offset);
+
+	if (cell != NULL || st->length == OPT_MAX_CELLS) return cell;
+
+	st->cells[st->length] = (Cellstate){
+		.offset = offset, .value = 0, .known = st->blank
+	};
+	return &st->cells[st->length++];
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool opt_summary(Optstate *entry, Asttree loop, Optstate *iterp,
+						uint32_t *stepp);
+static bool opt_apply(Optstate *st, Optstate *iterp, uint32_t step);
+
+/**
+ * @brief Exécute symboliquement une instruction.
+ * 
+ * @param st Le pointeur vers l'état.
+ * @param node L'instruction.
+ * @return bool Vaut false si l'instruction ne se résume pas à des additions
+ * de constantes (l'état n'est alors pas modifié).
+ * 
+ * @note Une multiplication (A_MUL) ou une boucle interne n'est acceptée que si
+ * la case pointée est connue : une boucle interne est alors remplacée par sa
+ * modification totale.
+ */
+static bool opt_step(Optstate *st, Asttree node) {
+	Cellstate *cell, *target;
+	Optstate iter;
+	uint32_t step, mask = opt_mask();
+
+	switch (node->type) {
+		case A_RIGHT:
+			st->cursor += node->id_lex;
+			return true;
+		case A_LEFT:
+			st->cursor -= node->id_lex;
+			return true;
+		case A_INC:
+		case A_DEC:
+			if ((cell = opt_cell(st, st->cursor + node->id_symb)) == NULL)
+				return false;
+
+			step = (uint32_t)node->id_lex;
+			cell->value = (cell->value + (node->type == A_INC ? step : -step))
+						  & mask;
+			return true;
+		case A_CLEAR:
+			if ((cell = opt_cell(st, st->cursor + node->id_symb)) == NULL)
+				return false;
+
+			cell->known = true;
+			cell->value = 0;
+			return true;
+		case A_MUL:
+			if ((cell = opt_cell(st, st->cursor)) == NULL || !cell->known)
+				return false;
+			if ((target = opt_cell(st, st->cursor + node->id_symb)) == NULL)
+				return false;
+
+			target->value = (target->value
+							 + cell->value * (uint32_t)node->id_lex) & mask;
+			return true;
+		case A_LOOP:
+			if ((cell = opt_cell(st, st->cursor)) == NULL || !cell->known)
+				return false;
+			if (cell->value == 0) return true;
+
+			return opt_summary(st, node, &iter, &step)
+				   && opt_apply(st, &iter, step);
+		default:
+			return false;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Indique si une case est supposée avoir la même valeur connue au début
+ * de chaque tour d'une boucle : c'est le cas des cases connues à l'entrée,
+ * hors compteur et hors cases écartées.
+ * 
+ * @param entry Le pointeur vers l'état à l'entrée de la boucle.
+ * @param demoted Les décalages des cases écartées.
+ * @param ndemoted Le nombre de cases écartées.
+ * @param offset Le décalage de la case.
+ * @param valuep L'emplacement qui reçoit la valeur supposée.
+ * @return bool Vaut true si la case est supposée connue.
+ */
+static bool opt_hypothesis(Optstate *entry, int demoted[], int ndemoted,
+						   int offset, uint32_t *valuep) {
+	Cellstate *cell = opt_find(entry, offset);
+
+	if (offset == entry->cursor) return false;
+	for (int i = 0; i < ndemoted; i++)
+		if (demoted[i] == offset) return false;
+
+	*valuep = (cell != NULL) ? cell->value : 0;
+	return (cell != NULL) ? cell->known : entry->blank;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Calcule la modification apportée à la bande par un tour d'une boucle
+ * affine.
+ * 
+ * Le corps est exécuté symboliquement en supposant que les cases connues à
+ * l'entrée gardent leur valeur d'un tour à l'autre ; une case dont la valeur
+ * change est écartée des hypothèses, et le corps est exécuté à nouveau.
+ * 
+ * @param entry Le pointeur vers l'état à l'entrée de la boucle.
+ * @param loop La boucle.
+ * @param iterp L'emplacement qui reçoit la modification d'un tour : les cases
+ * ajoutées (valeur ajoutée) et les cases fixées (valeur connue). Les cases
+ * supposées constantes n'y figurent pas.
+ * @param stepp L'emplacement qui reçoit la valeur ajoutée au compteur.
+ * @return bool Vaut false si la boucle n'est pas affine : corps déséquilibré,
+ * instruction autre qu'une addition de constante, ou compteur modifié d'une
+ * constante paire (le nombre de tours n'est alors pas défini).
+ */
+static bool opt_summary(Optstate *entry, Asttree loop, Optstate *iterp,
+						uint32_t *stepp) {
+	int demoted[OPT_MAX_CELLS], ndemoted = 0, kept;
+	Cellstate *cell;
+	uint32_t value;
+	bool consistent;
+
+	do {
+		*iterp = *entry;
+		for (int i = 0; i < iterp->length; i++) {
+			cell = &iterp->cells[i];
+			if (!opt_hypothesis(entry, demoted, ndemoted, cell->offset,
+								&value)) {
+				cell->known = false;
+				cell->value = 0;
+			}
+		}
+		for (int i = 0; i <= ndemoted; i++) {
+			cell = opt_cell(iterp, (i < ndemoted) ? demoted[i] : entry->cursor);
+			if (cell == NULL) return false;
+
+			cell->known = false;
+			cell->value = 0;
+		}
+
+		for (Asttree node = loop->son; !ast_is_empty(node);
+			 node = node->little_brother)
+			if (!opt_step(iterp, node)) return false;
+
+		if (iterp->cursor != entry->cursor) return false;
+
+		// Les hypothèses contredites sont écartées.
+		consistent = true;
+		for (int i = 0; i < iterp->length; i++) {
+			cell = &iterp->cells[i];
+			if (opt_hypothesis(entry, demoted, ndemoted, cell->offset, &value)
+				&& (!cell->known || cell->value != value)) {
+				demoted[ndemoted++] = cell->offset;
+				consistent = false;
+				break;
+			}
+		}
+	} while (!consistent);
+
+	// Compteur : modifié d'une constante impaire.
+	cell = opt_find(iterp, entry->cursor);
+	if (cell->known || (cell->value & 1) == 0) return false;
+	*stepp = cell->value;
+
+	// Seules les cases modifiées sont conservées.
+	kept = 0;
+	for (int i = 0; i < iterp->length; i++)
+		if (!opt_hypothesis(entry, demoted, ndemoted, iterp->cells[i].offset,
+							&value))
+			iterp->cells[kept++] = iterp->cells[i];
+	iterp->length = kept;
+
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Applique à un état la modification totale d'une boucle affine dont
+ * le compteur est connu.
+ * 
+ * @param st Le pointeur vers l'état à l'entrée de la boucle.
+ * @param iterp Le pointeur vers la modification d'un tour (opt_summary).
+ * @param step La valeur ajoutée au compteur à chaque tour.
+ * @return bool Vaut false si l'état ne peut pas suivre toutes les cases (il
+ * n'est alors pas modifié).
+ * 
+ * @note Le compteur x atteint zéro après n = -x / step tours (modulo 2^n).
+ */
+static bool opt_apply(Optstate *st, Optstate *iterp, uint32_t step) {
+	uint32_t mask = opt_mask(), turns;
+	Cellstate *cell, *counter;
+
+	for (int i = 0; i < iterp->length; i++)
+		if (opt_cell(st, iterp->cells[i].offset) == NULL) return false;
+
+	counter = opt_find(st, st->cursor);
+	turns = (0u - counter->value) * opt_inverse(step) & mask;
+
+	for (int i = 0; i < iterp->length; i++) {
+		cell = opt_find(st, iterp->cells[i].offset);
+		if (cell == counter) continue;
+
+		if (iterp->cells[i].known) {
+			if (turns != 0) *cell = iterp->cells[i];
+		} else {
+			cell->value = (cell->value + iterp->cells[i].value * turns) & mask;
+		}
+	}
+
+	counter->value = 0;
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à une chaîne en cours de construction l'addition d'une valeur
+ * (modulo 2^n) à une case décalée.
+ * 
+ * @param tailp L'emplacement de fin de chaîne.
+ * @param offset Le décalage de la case.
+ * @param value La valeur ajoutée.
+ * @return Asttree* Le nouvel emplacement de fin de chaîne.
+ */
+static Asttree *opt_add(Asttree *tailp, int offset, uint32_t value) {
+	int delta = opt_signed_value(value);
+
+	// -2^31 n'a pas d'opposé : il est retiré en deux fois.
+	if (delta == INT_MIN) {
+		tailp = opt_append(tailp, opt_node(A_DEC, INT_MAX / 2 + 1, offset));
+		delta += INT_MAX / 2 + 1;
+	}
+
+	if (delta > 0) tailp = opt_append(tailp, opt_node(A_INC, delta, offset));
+	if (delta < 0) tailp = opt_append(tailp, opt_node(A_DEC, -delta, offset));
+
+	return tailp;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la chaîne de noeuds équivalente à une boucle affine.
+ * 
+ * @param st Le pointeur vers l'état à l'entrée de la boucle.
+ * @param loop La boucle.
+ * @return Asttree La chaîne de remplacement, ou NULL si la boucle n'est pas
+ * affine.
+ * 
+ * @note Si le compteur x est inconnu, chaque case ajoutée de d par tour reçoit
+ * x * (-d / step) (A_MUL, sans effet si x est nul) ; une case fixée par la
+ * boucle, ou dont le facteur dépasse à la fois |d| et OPT_MAX_FACTOR, ne peut
+ * alors pas être remplacée. Si x est connu, la boucle est
+ * évaluée : seules les différences sont ajoutées.
+ */
+static Asttree opt_fold(Optstate *st, Asttree loop) {
+	Asttree head = ast_empty(), *tailp = &head;
+	Cellstate *counter, *before, *after;
+	Optstate final;
+	uint32_t step, factor, mask = opt_mask();
+	long long delta, product;
+	int offset;
+
+	if ((counter = opt_cell(st, st->cursor)) == NULL) return NULL;
+	if (!opt_summary(st, loop, &final, &step)) return NULL;
+
+	if (counter->known) {
+		Optstate iter = final;
+
+		final = *st;
+		if (!opt_apply(&final, &iter, step)) return NULL;
+
+		for (int i = 0; i < iter.length; i++) {
+			offset = iter.cells[i].offset;
+			if (offset == st->cursor) continue;
+
+			before = opt_find(st, offset);
+			after = opt_find(&final, offset);
+
+			// Case inconnue avant la boucle mais fixée par celle-ci : sa
+			// valeur relative avant la boucle n'est pas une valeur, elle est
+			// remise à zéro puis reçoit sa valeur finale.
+			if (!(before != NULL ? before->known : st->blank) && after->known) {
+				tailp = opt_append(tailp, opt_node(A_CLEAR, 1,
+								   offset - st->cursor));
+				tailp = opt_add(tailp, offset - st->cursor, after->value);
+				continue;
+			}
+			tailp = opt_add(tailp, offset - st->cursor, after->value
+							- ((before != NULL) ? before->value : 0));
+		}
+	} else {
+		for (int i = 0; i < final.length; i++)
+			if (final.cells[i].known) return NULL;
+
+		// Un facteur plus grand que le pas de la case et que OPT_MAX_FACTOR
+		// (pas du compteur différent de 1, en 16 ou 32 bits) ne se décompile
+		// qu'en un nombre démesuré de '+' ou de '-' : la boucle est gardée.
+		factor = (0u - opt_inverse(step)) & mask;
+		for (int i = 0; i < final.length; i++) {
+			delta = opt_signed_value(final.cells[i].value);
+			product = opt_signed_value(final.cells[i].value * factor);
+			if (llabs(product) > OPT_MAX_FACTOR && llabs(product) > llabs(delta))
+				return NULL;
+		}
+
+		for (int i = 0; i < final.length; i++) {
+			offset = final.cells[i].offset;
+			if (offset == st->cursor || final.cells[i].value == 0) continue;
+
+			tailp = opt_append(tailp, opt_node(A_MUL, opt_signed_value(
+							   final.cells[i].value * factor),
+							   offset - st->cursor));
+		}
+	}
+
+	opt_append(tailp, opt_node(A_CLEAR, 1, 0));
+
+	return head;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Met à jour l'état symbolique d'une suite d'instructions après l'une
+ * d'elles (les cases modifiées de façon inconnue deviennent inconnues).
+ * 
+ * @param st Le pointeur vers l'état.
+ * @param node L'instruction.
+ */
+static void opt_track(Optstate *st, Asttree node) {
+	Cellstate *cell;
+
+	switch (node->type) {
+		case A_PUT:
+			return;
+		case A_LOOP:
+		case A_SCAN:
+			// Position et cases inconnues, sauf la case pointée (nulle).
+			opt_reset(st, false);
+			cell = opt_cell(st, 0);
+			cell->known = true;
+			cell->value = 0;
+			return;
+		default:
+			if (opt_step(st, node)) return;
+
+			if ((cell = opt_cell(st, st->cursor + node->id_symb)) == NULL) {
+				opt_reset(st, false);
+				cell = opt_cell(st, node->id_symb);
+			}
+			cell->known = false;
+			cell->value = 0;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la chaîne de noeuds équivalente à une boucle idiomatique.
+ * 
+ * @param st Le pointeur vers l'état à l'entrée de la boucle.
+ * @param loop La boucle à analyser.
+ * @return Asttree La chaîne de remplacement, ou NULL si la boucle n'est pas
+ * reconnue.
+ * 
+ * @see optimize_idioms
+ */
+static Asttree opt_idiom(Optstate *st, Asttree loop) {
+	Asttree node;
+	int net = 0;
+
+	// Recherche d'une case nulle : le corps ne fait que déplacer le pointeur.
+	for (node = loop->son; !ast_is_empty(node); node = node->little_brother) {
+		if (node->type == A_RIGHT) net += node->id_lex;
+		else if (node->type == A_LEFT) net -= node->id_lex;
+		else break;
+	}
+	if (ast_is_empty(node)) return (net != 0) ? opt_node(A_SCAN, net, -1) : NULL;
+
+	return opt_fold(st, loop);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fonction auxiliaire à optimize_idioms : traite une suite
+ * d'instructions en suivant l'état symbolique de la bande.
+ * 
+ * @param tree La suite d'instructions.
+ * @param blank Vaut true si la bande est nulle au début de la suite (début du
+ * programme).
+ * @param replacedp Le nombre de boucles remplacées, incrémenté.
+ * @return Asttree La suite optimisée.
+ */
+static Asttree opt_idioms(Asttree tree, bool blank, int *replacedp) {
+	Asttree *linkp = &tree, node, repl, last;
+	Optstate st;
+
+	opt_reset(&st, blank);
+
+	for (; !ast_is_empty(*linkp); linkp = &last->little_brother) {
+		node = last = *linkp;
+
+		if (node->type != A_LOOP) {
+			opt_track(&st, node);
+			continue;
+		}
+
+		// Les boucles internes sont traitées en premier.
+		node->son = opt_idioms(node->son, false, replacedp);
+		if ((repl = opt_idiom(&st, node)) == NULL) {
+			opt_track(&st, node);
+			continue;
+		}
+
+		for (last = repl;; last = last->little_brother) {
+			opt_track(&st, last);
+			if (ast_is_empty(last->little_brother)) break;
+		}
+
+		// Remplacement de la boucle par la chaîne équivalente.
+		(*replacedp)++;
+		last->little_brother = node->little_brother;
+		node->little_brother = ast_empty();
+		ast_free(node);
+		*linkp = repl;
+	}
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Remplace les boucles idiomatiques d'un arbre par des noeuds dédiés.
+ * 
+ * Les boucles reconnues sont :
+ * - "[>]", "[<]", "[<>>]", ... : recherche d'une case nulle (A_SCAN) ;
+ * - les boucles affines : corps équilibré qui n'ajoute que des constantes à
+ *   des cases fixes, et dont le compteur change d'une constante impaire c
+ *   ("[-]", "[->+>++<<]", "[---->+<]", ...). Le nombre de tours, -x / c modulo
+ *   2^n (n étant la largeur des cases), est obtenu par l'inverse modulaire de
+ *   c : chaque case reçoit d'un coup sa modification totale (suite de A_MUL
+ *   suivie d'un A_CLEAR).
+ * 
+ * Les boucles imbriquées sont résumées de l'intérieur vers l'extérieur : une
+ * boucle interne dont le compteur est connu à chaque tour de la boucle externe
+ * (par exemple remis à zéro puis incrémenté) n'est qu'une suite d'additions
+ * constantes. Une boucle dont le compteur est connu à l'entrée (au début du
+ * programme, la bande est nulle) est entièrement évaluée.
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param replacedp L'emplacement qui reçoit le nombre de boucles remplacées.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les boucles remplacées sont
+ * libérées.
+ * @note Les facteurs obtenus dépendent de la largeur des cases choisie à la
+ * compilation.
+ */
+Asttree optimize_idioms(Asttree tree, int *replacedp) {
+	*replacedp = 0;
+	return opt_idioms(tree, true, replacedp);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à une chaîne en cours de construction le déplacement réel du
+ * pointeur de données correspondant au pointeur virtuel, puis remet ce dernier
+ * à zéro.
+ * 
+ * @param tailp L'emplacement de fin de chaîne.
+ * @param virtual Le pointeur vers le décalage du pointeur virtuel.
+ * @return Asttree* Le nouvel emplacement de fin de chaîne.
+ */
+static Asttree *opt_flush(Asttree *tailp, int *virtual) {
+	if (*virtual > 0) tailp = opt_append(tailp, opt_node(A_RIGHT, *virtual, 0));
+	if (*virtual < 0) tailp = opt_append(tailp, opt_node(A_LEFT, -*virtual, 0));
+
+	*virtual = 0;
+	return tailp;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Réécrit les blocs de base d'un arbre en opérations adressées par
+ * décalage.
+ * 
+ * Dans chaque suite d'instructions simples, les déplacements sont supprimés :
+ * les incrémentations, décrémentations, lectures, écritures et remises à zéro
+ * reçoivent le décalage (champ 'id_symb') de leur case par rapport à un
+ * pointeur virtuel. Le pointeur réel n'est déplacé qu'une fois, avant chaque
+ * boucle, recherche ou multiplication, et à la fin du bloc (donc une seule
+ * fois par itération pour le corps d'une boucle). Les incrémentations et
+ * décrémentations adjacentes d'une même case sont fusionnées.
+ * 
+ * @param tree L'arbre à optimiser.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les noeuds supprimés sont
+ * libérés.
+ */
+Asttree optimize_offsets(Asttree tree) {
+	Asttree head = ast_empty(), *tailp = &head, *prevp = NULL, node, next;
+	int virtual = 0, value;
+
+	for (node = tree; !ast_is_empty(node); node = next) {
+		next = node->little_brother;
+		node->little_brother = ast_empty();
+
+		switch (node->type) {
+			case A_RIGHT:
+			case A_LEFT:
+				virtual += (node->type == A_RIGHT) ? node->id_lex
+												   : -node->id_lex;
+				ast_free(node);
+				continue;
+			case A_INC:
+			case A_DEC:
+			case A_PUT:
+			case A_GET:
+			case A_CLEAR:
+				node->id_symb += virtual;
+				break;
+			case A_LOOP:
+				node->son = optimize_offsets(node->son);
+				/* fall through */
+			default:
+				tailp = opt_flush(tailp, &virtual);
+				prevp = NULL;
+		}
+
+		// Fusion avec l'incrémentation/décrémentation précédente.
+		if (prevp != NULL && (node->type == A_INC || node->type == A_DEC) &&
+			((*prevp)->type == A_INC || (*prevp)->type == A_DEC) &&
+			(*prevp)->id_symb == node->id_symb) {
+			value = ((*prevp)->type == A_INC ? 1 : -1) * (*prevp)->id_lex +
+					(node->type == A_INC ? 1 : -1) * node->id_lex;
+			ast_free(node);
+
+			if (value == 0) {
+				ast_free(*prevp);
+				*prevp = ast_empty();
+				tailp = prevp;
+				prevp = NULL;
+			} else {
+				(*prevp)->type = (value > 0) ? A_INC : A_DEC;
+				(*prevp)->id_lex = abs(value);
+			}
+			continue;
+		}
+
+		prevp = tailp;
+		tailp = opt_append(tailp, node);
+	}
+
+	opt_flush(tailp, &virtual);
+
+	return head;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la chaîne de noeuds équivalente à une boucle dont le nombre
+ * de tours est connu, déroulée.
+ * 
+ * @param st Le pointeur vers l'état à l'entrée de la boucle.
+ * @param loop La boucle.
+ * @param factor Le facteur de déroulage.
+ * @return Asttree La chaîne de remplacement (qui se termine par la boucle,
+ * au corps répété, si elle n'est que partiellement déroulée), ou NULL si la
+ * boucle ne peut pas être déroulée.
+ * 
+ * @see optimize_unroll
+ */
+static Asttree opt_unroll(Optstate *st, Asttree loop, int factor) {
+	Asttree head = ast_empty(), *tailp = &head, body = ast_empty(), *bodyp;
+	Cellstate *counter = opt_find(st, st->cursor);
+	uint32_t step = 0, turns, mask = opt_mask();
+	int nodes = 0, copies;
+
+	if (counter == NULL || !counter->known || counter->value == 0) return NULL;
+
+	// Corps sans déplacement : le compteur est la case de décalage 0.
+	for (Asttree node = loop->son; !ast_is_empty(node);
+		 node = node->little_brother) {
+		if (++nodes > OPT_UNROLL_MAX_NODES) return NULL;
+
+		switch (node->type) {
+			case A_INC:
+			case A_DEC:
+				if (node->id_symb == 0)
+					step += (node->type == A_INC) ? (uint32_t)node->id_lex
+												  : -(uint32_t)node->id_lex;
+				break;
+			case A_GET:
+			case A_CLEAR:
+			case A_MUL:
+				if (node->id_symb == 0) return NULL;
+				break;
+			case A_PUT:
+				break;
+			default:
+				return NULL;
+		}
+	}
+
+	step &= mask;
+	if ((step & 1) == 0) return NULL;
+	turns = (0u - counter->value) * opt_inverse(step) & mask;
+
+	// n mod k copies (ou n si n <= k), puis la boucle au corps répété.
+	copies = (turns <= (uint32_t)factor) ? (int)turns
+										 : (int)(turns % (uint32_t)factor);
+	for (int i = 0; i < copies; i++)
+		for (Asttree node = loop->son; !ast_is_empty(node);
+			 node = node->little_brother)
+			tailp = opt_append(tailp, opt_node(node->type, node->id_lex,
+											   node->id_symb));
+
+	if (turns <= (uint32_t)factor) return head;
+
+	bodyp = &body;
+	for (int i = 0; i < factor; i++)
+		for (Asttree node = loop->son; !ast_is_empty(node);
+			 node = node->little_brother)
+			bodyp = opt_append(bodyp, opt_node(node->type, node->id_lex,
+											   node->id_symb));
+
+	ast_free(loop->son);
+	loop->son = body;
+	loop->little_brother = ast_empty();
+	opt_append(tailp, loop);
+
+	return head;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Fonction auxiliaire à optimize_unroll : traite une suite
+ * d'instructions en suivant l'état symbolique de la bande.
+ * 
+ * @param tree La suite d'instructions.
+ * @param blank Vaut true si la bande est nulle au début de la suite (début du
+ * programme).
+ * @param factor Le facteur de déroulage.
+ * @param counts Les nombres de boucles entièrement et partiellement
+ * déroulées, incrémentés.
+ * @return Asttree La suite optimisée.
+ */
+static Asttree opt_unrolls(Asttree tree, bool blank, int factor, int counts[]) {
+	Asttree *linkp = &tree, node, next, repl, last;
+	Optstate st;
+
+	opt_reset(&st, blank);
+
+	for (; !ast_is_empty(*linkp); linkp = &last->little_brother) {
+		node = last = *linkp;
+		next = node->little_brother;
+
+		if (node->type == A_LOOP)
+			node->son = opt_unrolls(node->son, false, factor, counts);
+
+		if (node->type != A_LOOP
+			|| (repl = opt_unroll(&st, node, factor)) == NULL) {
+			opt_track(&st, node);
+			continue;
+		}
+
+		for (last = repl;; last = last->little_brother) {
+			opt_track(&st, last);
+			if (ast_is_empty(last->little_brother)) break;
+		}
+
+		// Une boucle partiellement déroulée termine la chaîne.
+		if (last == node) {
+			counts[1]++;
+		} else {
+			counts[0]++;
+			node->little_brother = ast_empty();
+			ast_free(node);
+		}
+		last->little_brother = next;
+		*linkp = repl;
+	}
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Déroule les boucles dont le nombre de tours est connu.
+ * 
+ * Une boucle est déroulée si son compteur est connu à l'entrée (remis à zéro
+ * puis initialisé, ou au début du programme) et si son corps, sans
+ * déplacement ni boucle interne, ne modifie son compteur que par des
+ * additions de constantes (d'une somme impaire). Si le nombre de tours n
+ * ne dépasse pas le facteur k, la boucle est remplacée par n copies de son
+ * corps ; sinon, n mod k copies précèdent une boucle dont le corps est
+ * répété k fois (un test de boucle pour k tours).
+ * 
+ * @param tree L'arbre à optimiser (adressé par décalage, voir
+ * optimize_offsets).
+ * @param factor Le facteur de déroulage (1 : aucun déroulage).
+ * @param fullp L'emplacement qui reçoit le nombre de boucles entièrement
+ * déroulées.
+ * @param partialp L'emplacement qui reçoit le nombre de boucles partiellement
+ * déroulées.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note L'arbre donné est modifié en place : les boucles entièrement déroulées
+ * sont libérées.
+ */
+Asttree optimize_unroll(Asttree tree, int factor, int *fullp,
+						int *partialp) {
+	int counts[2] = { 0, 0 };
+
+	if (factor >= 2) tree = opt_unrolls(tree, true, factor, counts);
+
+	*fullp = counts[0];
+	*partialp = counts[1];
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Passe de suppression du code mort (voir optimize_dead).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param changesp L'emplacement qui reçoit le nombre de noeuds supprimés.
+ * @return Asttree L'arbre optimisé.
+ */
+static Asttree opt_pass_dead(Asttree tree, int *changesp) {
+	return optimize_dead(tree, changesp);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Passe de remplacement des boucles idiomatiques (voir
+ * optimize_idioms).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param changesp L'emplacement qui reçoit le nombre de boucles remplacées.
+ * @return Asttree L'arbre optimisé.
+ */
+static Asttree opt_pass_idioms(Asttree tree, int *changesp) {
+	return optimize_idioms(tree, changesp);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Passe d'adressage par décalage (voir optimize_offsets).
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param changesp L'emplacement qui reçoit le nombre de noeuds supprimés
+ * (déplacements et additions fusionnées).
+ * @return Asttree L'arbre optimisé.
+ */
+static Asttree opt_pass_offsets(Asttree tree, int *changesp) {
+	int before = opt_count(tree);
+
+	tree = optimize_offsets(tree);
+	*changesp = before - opt_count(tree);
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Passe de déroulage des boucles (voir optimize_unroll), avec le
+ * facteur donné par FLAG_UNROLL.
+ * 
+ * @param tree L'arbre à optimiser.
+ * @param changesp L'emplacement qui reçoit le nombre de boucles déroulées.
+ * @return Asttree L'arbre optimisé.
+ */
+static Asttree opt_pass_unroll(Asttree tree, int *changesp) {
+	int full, partial;
+
+	tree = optimize_unroll(tree, options.unroll, &full, &partial);
+	*changesp = full + partial;
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Applique à un arbre les passes d'optimisation du niveau choisi par
+ * FLAG_OPT_LEVEL, dans l'ordre.
+ * 
+ * @param tree L'arbre à optimiser.
+ * @return Asttree L'arbre optimisé.
+ * 
+ * @note Avec FLAG_STATS, la durée, le nombre de noeuds avant et après et le
+ * nombre de changements de chaque passe sont affichés sur la sortie
+ * d'erreur.
+ */
+Asttree optimize(Asttree tree) {
+	// Passes dans l'ordre d'application, avec leur niveau minimal.
+	static const Optpass passes[] = {
+		{ "dead",    1, opt_pass_dead },
+		{ "idioms",  2, opt_pass_idioms },
+		{ "offsets", 1, opt_pass_offsets },
+		{ "unroll",  3, opt_pass_unroll }
+	};
+	int count = sizeof(passes) / sizeof(passes[0]), before = 0, changes;
+	clock_t start = 0;
+
+	if (options.stats)
+		fprintf(stderr, "- Optimisation (-O%d) : %d noeud(s)\n",
+				options.opt_level, opt_count(tree));
+
+	for (int i = 0; i < count; i++) {
+		if (passes[i].level > options.opt_level) continue;
+
+		if (options.stats) {
+			before = opt_count(tree);
+			start = clock();
+		}
+
+		changes = 0;
+		tree = passes[i].run(tree, &changes);
+
+		if (options.stats)
+			fprintf(stderr, "  + %-8s : %8.3f ms, %d -> %d noeud(s),"
+					" %d changement(s)\n", passes[i].name,
+					(double)(clock() - start) * 1000 / CLOCKS_PER_SEC, before,
+					opt_count(tree), changes);
+	}
+
+	return tree;
+}
+
+/* -------------------------------------------------------------------------- */
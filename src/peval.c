@@ -0,0 +1,333 @@
+/**
+ * @file peval.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'évaluation partielle d'un programme Brainfuck :
+ * le préfixe qui précède la première lecture est exécuté à la compilation, et
+ * seul le reste du programme est conservé, avec l'état de la bande et la
+ * sortie obtenus.
+ * @date 2024-05-18
+ * 
+ * 
+ */
+#include "peval.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def PEVAL_INITIAL_OUTPUT
+ * @brief Capacité initiale (en valeurs) de la sortie du préfixe.
+ * 
+ */
+#define PEVAL_INITIAL_OUTPUT 256
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Pevalstate
+ * @struct Pevalstate
+ * @brief Structure représentant l'état courant de l'évaluation.
+ * 
+ */
+typedef struct Pevalstate {
+	uint32_t *tape;		///< Bande d'évaluation (PEVAL_TAPE_SIZE cases).
+	long high;			///< Cases significatives (au-delà : nulles).
+	long ptr;			///< Position du pointeur.
+	uint32_t mask;		///< Masque de la largeur des cases.
+	uint32_t *output;	///< Valeurs écrites.
+	long length;		///< Nombre de valeurs écrites.
+	long capacity;		///< Nombre de valeurs allouées.
+	long steps;			///< Pas effectués.
+	long budget;		///< Nombre maximal de pas.
+	int stop;			///< Cause d'arrêt.
+} Pevalstate;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la case située à 'offset' cases du pointeur, ou NULL (en
+ * arrêtant l'évaluation) si elle est hors de la bande d'évaluation.
+ * 
+ * @param sp Le pointeur vers l'état de l'évaluation.
+ * @param offset Le décalage de la case.
+ * @return uint32_t* La case, ou NULL.
+ * 
+ * @note La case est considérée comme écrite : elle étend, au besoin, les cases
+ * significatives.
+ */
+static uint32_t *peval_cell(Pevalstate *sp, long offset) {
+	long pos = sp->ptr + offset;
+
+	if (pos < 0 || pos >= PEVAL_TAPE_SIZE) {
+		sp->stop = PEVAL_BOUNDS;
+		return NULL;
+	}
+
+	if (pos >= sp->high) sp->high = pos + 1;
+
+	return &sp->tape[pos];
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute une valeur à la sortie du préfixe.
+ * 
+ * @param sp Le pointeur vers l'état de l'évaluation.
+ * @param value La valeur écrite.
+ */
+static void peval_put(Pevalstate *sp, uint32_t value) {
+	uint32_t *output;
+
+	if (sp->length == sp->capacity) {
+		sp->capacity = (sp->capacity == 0) ? PEVAL_INITIAL_OUTPUT
+										   : 2 * sp->capacity;
+		output = (uint32_t *)realloc(sp->output,
+									 sp->capacity * sizeof(uint32_t));
+		if (output == NULL)
+			merror("peval_put() : Échec de l'allocation de mémoire à 'output'"
+				   " ! [%s]", strerror(errno));
+
+		sp->output = output;
+	}
+
+	sp->output[sp->length++] = value;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool peval_list(Pevalstate *sp, Asttree tree);
+
+/**
+ * @brief Évalue une instruction (sans ses petits-frères).
+ * 
+ * @param sp Le pointeur vers l'état de l'évaluation.
+ * @param tree L'arbre de l'instruction.
+ * @return bool Vaut false si l'évaluation s'est arrêtée.
+ * 
+ * @note Une instruction qui ne peut pas être évaluée (lecture, case hors de
+ * la bande) est arrêtée avant toute modification de la bande.
+ */
+static bool peval_node(Pevalstate *sp, Asttree tree) {
+	int count = tree->id_lex, offset = tree->id_symb;
+	uint32_t *cell, *target;
+
+	if (++sp->steps > sp->budget) {
+		sp->stop = PEVAL_BUDGET;
+		return false;
+	}
+
+	switch (tree->type) {
+		case A_LOOP:
+			while ((cell = peval_cell(sp, 0)) != NULL && *cell != 0) {
+				if (!peval_list(sp, tree->son)) return false;
+				if (++sp->steps > sp->budget) {
+					sp->stop = PEVAL_BUDGET;
+					return false;
+				}
+			}
+			return cell != NULL;
+		case A_INC:
+		case A_DEC:
+		case A_CLEAR:
+			if ((cell = peval_cell(sp, offset)) == NULL) return false;
+
+			if (tree->type == A_INC) *cell = (*cell + count) & sp->mask;
+			else if (tree->type == A_DEC) *cell = (*cell - count) & sp->mask;
+			else *cell = 0;
+			return true;
+		case A_LEFT:
+			sp->ptr -= count;
+			return true;
+		case A_RIGHT:
+			sp->ptr += count;
+			return true;
+		case A_PUT:
+			if ((cell = peval_cell(sp, offset)) == NULL) return false;
+
+			for (int i = 0; i < count; i++) peval_put(sp, *cell);
+			return true;
+		case A_GET:
+			sp->stop = PEVAL_GET;
+			return false;
+		case A_SCAN:
+			while ((cell = peval_cell(sp, 0)) != NULL && *cell != 0)
+				sp->ptr += count;
+			return cell != NULL;
+		case A_MUL:
+			if ((cell = peval_cell(sp, 0)) == NULL) return false;
+			if (*cell == 0) return true;
+			if ((target = peval_cell(sp, offset)) == NULL) return false;
+
+			*target = (*target + *cell * (uint32_t)count) & sp->mask;
+			return true;
+		default:
+			merror("peval_node() : 'tree->type' inconnu !");
+	}
+
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Évalue une instruction et tous ses petits-frères.
+ * 
+ * @param sp Le pointeur vers l'état de l'évaluation.
+ * @param tree L'arbre de la première instruction.
+ * @return bool Vaut false si l'évaluation s'est arrêtée.
+ */
+static bool peval_list(Pevalstate *sp, Asttree tree) {
+	for (; !ast_is_empty(tree); tree = tree->little_brother)
+		if (!peval_node(sp, tree)) return false;
+
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Évalue un programme jusqu'à sa première lecture, dans la limite
+ * d'un nombre de pas.
+ * 
+ * @param tree L'arbre (optimisé) du programme.
+ * @param budget Le nombre maximal de pas d'évaluation.
+ * @param bits La largeur des cases (8, 16 ou 32 bits).
+ * @return Peval Le reste du programme et son état initial.
+ * 
+ * @note Seules les boucles de premier niveau peuvent être interrompues après
+ * avoir modifié la bande : la partie significative de la bande est copiée
+ * avant chacune d'elles, et restaurée si elle est interrompue.
+ */
+Peval peval(Asttree tree, long budget, int bits) {
+	Pevalstate state = {
+		.high = 0, .ptr = 0, .output = NULL, .length = 0, .capacity = 0,
+		.steps = 0, .budget = budget, .stop = PEVAL_END,
+		.mask = (uint32_t)((1ull << bits) - 1)
+	};
+	Pevalstate saved;
+	uint32_t *snapshot;
+	Peval pe;
+	int evaluated = 0;
+
+	state.tape = (uint32_t *)calloc(PEVAL_TAPE_SIZE, sizeof(uint32_t));
+	snapshot = (uint32_t *)malloc(PEVAL_TAPE_SIZE * sizeof(uint32_t));
+	if (state.tape == NULL || snapshot == NULL)
+		merror("peval() : Échec de l'allocation de mémoire à la bande ! [%s]",
+			   strerror(errno));
+
+	for (; !ast_is_empty(tree); tree = tree->little_brother, evaluated++) {
+		saved = state;
+		if (tree->type == A_LOOP)
+			memcpy(snapshot, state.tape, state.high * sizeof(uint32_t));
+
+		if (peval_node(&state, tree)) continue;
+
+		// Retour à l'état qui précède l'instruction interrompue.
+		if (tree->type == A_LOOP) {
+			memcpy(state.tape, snapshot, saved.high * sizeof(uint32_t));
+			memset(state.tape + saved.high, 0,
+				   (state.high - saved.high) * sizeof(uint32_t));
+		}
+		state.high = saved.high;
+		state.ptr = saved.ptr;
+		state.length = saved.length;
+		state.steps = saved.steps;
+		break;
+	}
+
+	free(snapshot);
+
+	pe.rest = tree;
+	pe.tape = state.tape;
+	pe.cells = state.high;
+	pe.ptr = state.ptr;
+	pe.output = state.output;
+	pe.length = state.length;
+	pe.steps = state.steps;
+	pe.evaluated = evaluated;
+	pe.stop = state.stop;
+
+	return pe;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne true si l'évaluation partielle n'a rien évalué (le reste est
+ * alors le programme entier, sur une bande nulle).
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @return bool Vaut true si l'évaluation est sans effet.
+ */
+bool peval_is_empty(Peval pe) {
+	return pe.evaluated == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit d'un bloc les valeurs écrites par le préfixe sur la sortie
+ * donnée (comme putchar, une valeur par octet).
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @param out La sortie.
+ */
+void peval_write(Peval pe, FILE *out) {
+	unsigned char *bytes;
+
+	if (pe.length == 0) return;
+
+	bytes = (unsigned char *)malloc(pe.length);
+	if (bytes == NULL)
+		merror("peval_write() : Échec de l'allocation de mémoire ! [%s]",
+			   strerror(errno));
+
+	for (long i = 0; i < pe.length; i++) bytes[i] = (unsigned char)pe.output[i];
+	fwrite(bytes, 1, pe.length, out);
+
+	free(bytes);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime le bilan de l'évaluation partielle sur la sortie donnée.
+ * 
+ * @param pe Le résultat de l'évaluation.
+ * @param out La sortie sur laquelle imprimer le bilan.
+ */
+void peval_print(Peval pe, FILE *out) {
+	char *stops[] = PEVAL_STOPS_STRINGS;
+
+	fprintf(out, "- Évaluation partielle : %ld pas, %d instruction(s) de"
+			" premier niveau, arrêt : %s\n", pe.steps, pe.evaluated,
+			stops[pe.stop]);
+	fprintf(out, "  + %ld valeur(s) écrite(s), %ld case(s) initialisée(s),"
+			" pointeur en %ld\n", pe.length, pe.cells, pe.ptr);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée au résultat d'une évaluation (mais pas le
+ * reste du programme).
+ * 
+ * @param pep Le pointeur vers le résultat à libérer.
+ */
+void peval_free(Peval *pep) {
+	if (pep == NULL) return;
+
+	free(pep->tape);
+	free(pep->output);
+	pep->tape = NULL;
+	pep->output = NULL;
+	pep->rest = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
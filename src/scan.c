@@ -0,0 +1,298 @@
+/**
+ * @file scan.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la recherche vectorisée (SSE2/AVX2) d'une case
+ * nulle sur la bande de données, utilisée par les boucles de recherche
+ * ("[>]", "[<<]", "[>>>>]", ...).
+ * @date 2024-05-08
+ * 
+ * 
+ */
+#include "scan.h"
+
+#if SCAN_X86
+#include <immintrin.h>
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @var Scanfn scan_impl
+ * @brief Implémentation de la recherche choisie pour le processeur courant.
+ * 
+ * @note Vaut NULL tant que la recherche n'a pas été utilisée.
+ */
+static Scanfn scan_impl;
+
+/**
+ * @var char * scan_impl_name
+ * @brief Nom du jeu d'instructions de l'implémentation choisie.
+ * 
+ */
+static char *scan_impl_name;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version scalaire de la recherche de case nulle.
+ * 
+ * @param p La case de départ.
+ * @param step Le pas (signé) de la recherche.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case nulle rencontrée.
+ */
+static void *scan_scalar(void *p, int step, int size) {
+	uint8_t *p8 = p;
+	uint16_t *p16 = p;
+	uint32_t *p32 = p;
+
+	switch (size) {
+		case 1:
+			while (*p8 != 0) p8 += step;
+			return p8;
+		case 2:
+			while (*p16 != 0) p16 += step;
+			return p16;
+		default:
+			while (*p32 != 0) p32 += step;
+			return p32;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne true si la case donnée est nulle.
+ * 
+ * @param p La case.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return bool Vaut true si la case est nulle.
+ */
+static bool scan_is_zero(void *p, int size) {
+	switch (size) {
+		case 1:  return *(uint8_t *)p == 0;
+		case 2:  return *(uint16_t *)p == 0;
+		default: return *(uint32_t *)p == 0;
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+#if SCAN_X86
+
+/**
+ * @brief Retourne le masque (un bit par octet d'un bloc de 'bytes' octets) des
+ * octets de début des cases visitées par une recherche dont la case de départ
+ * se situe à l'octet 'start' de son bloc.
+ * 
+ * @param bytes La taille d'un bloc (vecteur) en octets.
+ * @param start La position (en octets) de la case de départ dans son bloc.
+ * @param span L'écart (en octets, non signé) entre deux cases visitées,
+ * diviseur de la taille d'un bloc.
+ * @return uint32_t Le masque des cases visitées.
+ * 
+ * @note L'écart divisant la taille d'un bloc, les cases visitées occupent les
+ * mêmes positions dans tous les blocs.
+ */
+static uint32_t scan_pattern(int bytes, int start, int span) {
+	uint32_t pattern = 0;
+
+	for (int b = start % span; b < bytes; b += span)
+		pattern |= (uint32_t)1 << b;
+
+	return pattern;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compare à zéro chaque case (de 'size' octets) d'un vecteur SSE2.
+ * 
+ * @param v Le vecteur.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return __m128i Le vecteur des comparaisons (octets à 0xFF si nuls).
+ */
+__attribute__((target("sse2")))
+static inline __m128i scan_cmp_sse2(__m128i v, int size) {
+	const __m128i zero = _mm_setzero_si128();
+
+	switch (size) {
+		case 1:  return _mm_cmpeq_epi8(v, zero);
+		case 2:  return _mm_cmpeq_epi16(v, zero);
+		default: return _mm_cmpeq_epi32(v, zero);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compare à zéro chaque case (de 'size' octets) d'un vecteur AVX2.
+ * 
+ * @param v Le vecteur.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return __m256i Le vecteur des comparaisons (octets à 0xFF si nuls).
+ */
+__attribute__((target("avx2")))
+static inline __m256i scan_cmp_avx2(__m256i v, int size) {
+	const __m256i zero = _mm256_setzero_si256();
+
+	switch (size) {
+		case 1:  return _mm256_cmpeq_epi8(v, zero);
+		case 2:  return _mm256_cmpeq_epi16(v, zero);
+		default: return _mm256_cmpeq_epi32(v, zero);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version SSE2 de la recherche de case nulle (blocs de 16 octets).
+ * 
+ * @param p La case de départ.
+ * @param step Le pas (signé) de la recherche.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case nulle rencontrée.
+ * 
+ * @note Les chargements sont alignés : un bloc ne chevauche jamais deux pages
+ * mémoire, la recherche ne lit donc aucune page que la version scalaire ne
+ * lirait pas. Les octets hors des cases visitées sont masqués.
+ */
+__attribute__((target("sse2")))
+static void *scan_sse2(void *p, int step, int size) {
+	char *block;
+	uint32_t pattern, mask, m;
+	int start, span = abs(step) * size;
+
+	if (scan_is_zero(p, size)) return p;
+	if (16 % span != 0) return scan_scalar(p, step, size);
+
+	block = (char *)((uintptr_t)p & ~(uintptr_t)15);
+	start = (int)((char *)p - block);
+	pattern = scan_pattern(16, start, span);
+
+	if (step > 0) {
+		mask = pattern & (0xFFFFu << start);
+		for (;; block += 16, mask = pattern) {
+			m = _mm_movemask_epi8(scan_cmp_sse2(
+					_mm_load_si128((__m128i *)block), size)) & mask;
+			if (m) return block + __builtin_ctz(m);
+		}
+	}
+
+	mask = pattern & ((2u << start) - 1);
+	for (;; block -= 16, mask = pattern) {
+		m = _mm_movemask_epi8(scan_cmp_sse2(
+				_mm_load_si128((__m128i *)block), size)) & mask;
+		if (m) return block + 31 - __builtin_clz(m);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version AVX2 de la recherche de case nulle (blocs de 32 octets).
+ * 
+ * @param p La case de départ.
+ * @param step Le pas (signé) de la recherche.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case nulle rencontrée.
+ * 
+ * @see scan_sse2
+ */
+__attribute__((target("avx2")))
+static void *scan_avx2(void *p, int step, int size) {
+	char *block;
+	uint32_t pattern, mask, m;
+	int start, span = abs(step) * size;
+
+	if (scan_is_zero(p, size)) return p;
+	if (32 % span != 0) return scan_scalar(p, step, size);
+
+	block = (char *)((uintptr_t)p & ~(uintptr_t)31);
+	start = (int)((char *)p - block);
+	pattern = scan_pattern(32, start, span);
+
+	if (step > 0) {
+		mask = pattern & (0xFFFFFFFFu << start);
+		for (;; block += 32, mask = pattern) {
+			m = (uint32_t)_mm256_movemask_epi8(scan_cmp_avx2(
+					_mm256_load_si256((__m256i *)block), size)) & mask;
+			if (m) return block + __builtin_ctz(m);
+		}
+	}
+
+	mask = pattern & (uint32_t)((2ull << start) - 1);
+	for (;; block -= 32, mask = pattern) {
+		m = (uint32_t)_mm256_movemask_epi8(scan_cmp_avx2(
+				_mm256_load_si256((__m256i *)block), size)) & mask;
+		if (m) return block + 31 - __builtin_clz(m);
+	}
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Choisit l'implémentation de la recherche selon les capacités du
+ * processeur courant.
+ * 
+ */
+static void scan_select() {
+	scan_impl = scan_scalar;
+	scan_impl_name = "scalaire";
+
+#if SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		scan_impl = scan_avx2;
+		scan_impl_name = "AVX2";
+	} else if (__builtin_cpu_supports("sse2")) {
+		scan_impl = scan_sse2;
+		scan_impl_name = "SSE2";
+	}
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la première case nulle rencontrée en partant de la case
+ * donnée et en avançant par pas de 'step' cases de 'size' octets.
+ * 
+ * @param p La case de départ.
+ * @param step Le pas (signé) de la recherche.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case nulle rencontrée.
+ * 
+ * @note Le jeu d'instructions (AVX2, SSE2 ou scalaire) est choisi à la
+ * première utilisation, selon les capacités du processeur (cpuid).
+ * @note Les recherches dont l'écart en octets entre deux cases visitées
+ * divise la taille d'un vecteur (16 octets en SSE2, 32 en AVX2) sont
+ * vectorisées ; les autres utilisent la version scalaire.
+ */
+void *scan_zero(void *p, int step, int size) {
+	if (scan_impl == NULL) scan_select();
+
+	return scan_impl(p, step, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nom du jeu d'instructions utilisé par la recherche de
+ * case nulle sur le processeur courant.
+ * 
+ * @return char* Le nom du jeu d'instructions.
+ */
+char *scan_isa() {
+	if (scan_impl == NULL) scan_select();
+
+	return scan_impl_name;
+}
+
+/* -------------------------------------------------------------------------- */
\ No newline at end of file
@@ -0,0 +1,237 @@
+/**
+ * @file simd.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'ajout vectorisé (SSE2/AVX2) d'un vecteur de
+ * constantes à des cases consécutives de la bande de données, utilisé par les
+ * blocs de base qui modifient de longues suites de cases (">+++>++>+++++").
+ * @date 2024-05-24
+ * 
+ * 
+ */
+#include "simd.h"
+
+#if SCAN_X86
+#include <immintrin.h>
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @var Simdfn simd_impl
+ * @brief Implémentation de l'ajout choisie pour le processeur courant.
+ * 
+ * @note Vaut NULL tant que l'ajout n'a pas été utilisé.
+ */
+static Simdfn simd_impl;
+
+/**
+ * @var char * simd_impl_name
+ * @brief Nom du jeu d'instructions de l'implémentation choisie.
+ * 
+ */
+static char *simd_impl_name;
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version scalaire de l'ajout d'un vecteur de constantes.
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ */
+static void simd_scalar(void *p, const void *values, int length, int size) {
+	switch (size) {
+		case 1:
+			for (int k = 0; k < length; k++)
+				((uint8_t *)p)[k] += ((const uint8_t *)values)[k];
+			break;
+		case 2:
+			for (int k = 0; k < length; k++)
+				((uint16_t *)p)[k] += ((const uint16_t *)values)[k];
+			break;
+		default:
+			for (int k = 0; k < length; k++)
+				((uint32_t *)p)[k] += ((const uint32_t *)values)[k];
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+#if SCAN_X86
+
+/**
+ * @brief Ajoute deux vecteurs SSE2 case par case (cases de 'size' octets).
+ * 
+ * @param a Le premier vecteur.
+ * @param b Le second vecteur.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return __m128i La somme (modulaire) des vecteurs.
+ */
+__attribute__((target("sse2")))
+static inline __m128i simd_sum_sse2(__m128i a, __m128i b, int size) {
+	switch (size) {
+		case 1:  return _mm_add_epi8(a, b);
+		case 2:  return _mm_add_epi16(a, b);
+		default: return _mm_add_epi32(a, b);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute deux vecteurs AVX2 case par case (cases de 'size' octets).
+ * 
+ * @param a Le premier vecteur.
+ * @param b Le second vecteur.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return __m256i La somme (modulaire) des vecteurs.
+ */
+__attribute__((target("avx2")))
+static inline __m256i simd_sum_avx2(__m256i a, __m256i b, int size) {
+	switch (size) {
+		case 1:  return _mm256_add_epi8(a, b);
+		case 2:  return _mm256_add_epi16(a, b);
+		default: return _mm256_add_epi32(a, b);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version SSE2 de l'ajout d'un vecteur de constantes (blocs de 16
+ * octets).
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ */
+__attribute__((target("sse2")))
+static void simd_sse2(void *p, const void *values, int length, int size) {
+	char *cells = p;
+	const char *constants = values;
+	int bytes = length * size, b = 0;
+
+	for (; b + 16 <= bytes; b += 16)
+		_mm_storeu_si128((__m128i *)(cells + b), simd_sum_sse2(
+			_mm_loadu_si128((__m128i *)(cells + b)),
+			_mm_loadu_si128((const __m128i *)(constants + b)), size));
+
+	simd_scalar(cells + b, constants + b, (bytes - b) / size, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Version AVX2 de l'ajout d'un vecteur de constantes (blocs de 32
+ * octets, puis un bloc de 16 octets).
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * 
+ * @see simd_sse2
+ */
+__attribute__((target("avx2")))
+static void simd_avx2(void *p, const void *values, int length, int size) {
+	char *cells = p;
+	const char *constants = values;
+	int bytes = length * size, b = 0;
+
+	for (; b + 32 <= bytes; b += 32)
+		_mm256_storeu_si256((__m256i *)(cells + b), simd_sum_avx2(
+			_mm256_loadu_si256((__m256i *)(cells + b)),
+			_mm256_loadu_si256((const __m256i *)(constants + b)), size));
+
+	simd_sse2(cells + b, constants + b, (bytes - b) / size, size);
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Choisit l'implémentation de l'ajout selon les capacités du
+ * processeur courant.
+ * 
+ */
+static void simd_select() {
+	simd_impl = simd_scalar;
+	simd_impl_name = "scalaire";
+
+#if SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		simd_impl = simd_avx2;
+		simd_impl_name = "AVX2";
+	} else if (__builtin_cpu_supports("sse2")) {
+		simd_impl = simd_sse2;
+		simd_impl_name = "SSE2";
+	}
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à chacune des 'length' cases consécutives qui commencent à la
+ * case donnée la constante correspondante (arithmétique modulaire).
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * 
+ * @note Le jeu d'instructions (AVX2, SSE2 ou scalaire) est choisi à la
+ * première utilisation, selon les capacités du processeur (cpuid), comme pour
+ * la recherche de case nulle (voir scan.h).
+ * @note Les accès ne sont pas alignés : seules les cases données sont lues et
+ * écrites, la fin de la suite étant traitée case par case.
+ */
+void simd_add(void *p, const void *values, int length, int size) {
+	if (simd_impl == NULL) simd_select();
+
+	simd_impl(p, values, length, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Affecte à chacune des 'length' cases consécutives qui commencent à
+ * la case donnée la constante correspondante.
+ * 
+ * @param p La première case.
+ * @param values Les constantes, de même taille que les cases, ou NULL pour
+ * remettre les cases à zéro.
+ * @param length Le nombre de cases.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * 
+ * @note memcpy et memset sont déjà vectorisés par la bibliothèque C.
+ */
+void simd_set(void *p, const void *values, int length, int size) {
+	if (values == NULL) memset(p, 0, length * size);
+	else memcpy(p, values, length * size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nom du jeu d'instructions utilisé par l'ajout vectorisé
+ * sur le processeur courant.
+ * 
+ * @return char* Le nom du jeu d'instructions.
+ */
+char *simd_isa() {
+	if (simd_impl == NULL) simd_select();
+
+	return simd_impl_name;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,221 @@
+/**
+ * @file sparse.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la bande de données creuse de la machine
+ * virtuelle : une table à deux niveaux de pages de taille fixe, allouées au
+ * premier accès et indexées par une position signée sur 64 bits.
+ * @date 2024-05-16
+ * 
+ * 
+ */
+#include "sparse.h"
+
+/*
+ * Découpage d'une position (vue comme un entier non signé) :
+ * 
+ *   | plage (clé du répertoire) | page dans la plage | case dans la page |
+ *                                 SPARSE_LEAF_BITS     SPARSE_PAGE_BITS
+ */
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def SPARSE_DIR_CAPACITY
+ * @brief Capacité initiale du répertoire (puissance de 2).
+ * 
+ */
+#define SPARSE_DIR_CAPACITY 16
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne l'entrée du répertoire correspondant à la clé donnée : celle
+ * de la plage si elle existe, l'entrée libre où l'insérer sinon.
+ * 
+ * @param dir Le répertoire.
+ * @param capacity La capacité du répertoire (puissance de 2).
+ * @param key La clé de la plage.
+ * @return Sparseleaf* L'entrée du répertoire.
+ */
+static Sparseleaf *sparse_slot(Sparseleaf *dir, size_t capacity,
+							   uint64_t key) {
+	// Hachage multiplicatif de Fibonacci, puis sondage linéaire.
+	size_t i = (size_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+
+	for (;; i++) {
+		i &= capacity - 1;
+		if (dir[i].pages == NULL || dir[i].key == key) return &dir[i];
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Double la capacité du répertoire de la bande donnée.
+ * 
+ * @param tapep Le pointeur vers la bande.
+ */
+static void sparse_grow(Sparsetape *tapep) {
+	size_t capacity = tapep->capacity * 2;
+	Sparseleaf *dir = (Sparseleaf *)calloc(capacity, sizeof(Sparseleaf));
+
+	if (dir == NULL)
+		merror("sparse_grow() : Échec de l'allocation de mémoire au répertoire"
+			   " ! [%s]", strerror(errno));
+
+	for (size_t i = 0; i < tapep->capacity; i++)
+		if (tapep->dir[i].pages != NULL)
+			*sparse_slot(dir, capacity, tapep->dir[i].key) = tapep->dir[i];
+
+	free(tapep->dir);
+	tapep->dir = dir;
+	tapep->capacity = capacity;
+	tapep->last = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialise une bande de données creuse vide.
+ * 
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return Sparsetape La bande initialisée.
+ */
+Sparsetape sparse_init(int size) {
+	Sparsetape tape = {
+		.capacity = SPARSE_DIR_CAPACITY, .leaves = 0, .last = NULL,
+		.size = size, .pages = 0, .low = 0, .high = 0
+	};
+
+	tape.dir = (Sparseleaf *)calloc(tape.capacity, sizeof(Sparseleaf));
+	if (tape.dir == NULL)
+		merror("sparse_init() : Échec de l'allocation de mémoire au répertoire"
+			   " ! [%s]", strerror(errno));
+
+	return tape;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la première case de la page qui contient la position donnée,
+ * en allouant (à zéro) la page si elle n'a jamais été touchée.
+ * 
+ * @param tapep Le pointeur vers la bande.
+ * @param pos La position (signée) d'une case.
+ * @return void* La première case de la page.
+ * 
+ * @note Un échec d'allocation provoquera une erreur.
+ * @note La dernière plage consultée est mémorisée : des accès proches ne
+ * consultent pas le répertoire.
+ */
+void *sparse_page(Sparsetape *tapep, int64_t pos) {
+	uint64_t key = (uint64_t)pos >> (SPARSE_PAGE_BITS + SPARSE_LEAF_BITS);
+	size_t index = ((uint64_t)pos >> SPARSE_PAGE_BITS)
+				   & (SPARSE_LEAF_PAGES - 1);
+	Sparseleaf *leaf = tapep->last;
+	void **pagep;
+
+	if (leaf == NULL || leaf->key != key) {
+		leaf = sparse_slot(tapep->dir, tapep->capacity, key);
+
+		if (leaf->pages == NULL) {
+			// Le répertoire reste au plus à moitié plein.
+			if (2 * (tapep->leaves + 1) > tapep->capacity) {
+				sparse_grow(tapep);
+				leaf = sparse_slot(tapep->dir, tapep->capacity, key);
+			}
+
+			leaf->pages = (void **)calloc(SPARSE_LEAF_PAGES, sizeof(void *));
+			if (leaf->pages == NULL)
+				merror("sparse_page() : Échec de l'allocation de mémoire à une"
+					   " plage ! [%s]", strerror(errno));
+
+			leaf->key = key;
+			tapep->leaves++;
+		}
+
+		tapep->last = leaf;
+	}
+
+	pagep = &leaf->pages[index];
+	if (*pagep == NULL) {
+		*pagep = calloc(SPARSE_PAGE_CELLS, tapep->size);
+		if (*pagep == NULL)
+			merror("sparse_page() : Échec de l'allocation de mémoire à une page"
+				   " ! [%s]", strerror(errno));
+
+		if (tapep->pages == 0 || SPARSE_PAGE_BASE(pos) < tapep->low)
+			tapep->low = SPARSE_PAGE_BASE(pos);
+		if (tapep->pages == 0 || SPARSE_PAGE_BASE(pos) > tapep->high)
+			tapep->high = SPARSE_PAGE_BASE(pos);
+		tapep->pages++;
+	}
+
+	return *pagep;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne la case située à la position donnée.
+ * 
+ * @param tapep Le pointeur vers la bande.
+ * @param pos La position (signée) de la case.
+ * @return void* La case.
+ * 
+ * @see sparse_page
+ */
+void *sparse_cell(Sparsetape *tapep, int64_t pos) {
+	return (char *)sparse_page(tapep, pos)
+		   + (pos - SPARSE_PAGE_BASE(pos)) * tapep->size;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime l'occupation de la bande (pages allouées et étendue touchée)
+ * sur la sortie donnée.
+ * 
+ * @param tape La bande.
+ * @param out La sortie sur laquelle imprimer l'occupation.
+ */
+void sparse_print(Sparsetape tape, FILE *out) {
+	fprintf(out, "- Bande creuse : %ld page(s) de %ld cases (%ld octets),"
+			" %zu plage(s)\n", tape.pages, (long)SPARSE_PAGE_CELLS,
+			tape.pages * (long)SPARSE_PAGE_CELLS * tape.size, tape.leaves);
+	if (tape.pages > 0)
+		fprintf(out, "  + Étendue touchée : [%" PRId64 ", %" PRId64 "]\n",
+				tape.low, tape.high + SPARSE_PAGE_CELLS - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à la bande.
+ * 
+ * @param tapep Le pointeur vers la bande à libérer.
+ */
+void sparse_free(Sparsetape *tapep) {
+	if (tapep == NULL || tapep->dir == NULL) return;
+
+	for (size_t i = 0; i < tapep->capacity; i++) {
+		if (tapep->dir[i].pages == NULL) continue;
+
+		for (int64_t j = 0; j < SPARSE_LEAF_PAGES; j++)
+			free(tapep->dir[i].pages[j]);
+		free(tapep->dir[i].pages);
+	}
+
+	free(tapep->dir);
+	tapep->dir = NULL;
+	tapep->last = NULL;
+	tapep->capacity = tapep->leaves = 0;
+	tapep->pages = 0;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,399 @@
+/**
+ * @file super.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant le choix des superinstructions d'un programme
+ * linéaire à partir d'un profil d'exécution : fréquences des paires et des
+ * triplets d'instructions consécutives, enregistrées dans un fichier.
+ * @date 2024-05-17
+ * 
+ * 
+ */
+#include "super.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   MACROS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @def SUPER_LINE_LENGTH
+ * @brief Longueur maximale d'une ligne d'un fichier de profil.
+ * 
+ */
+#define SUPER_LINE_LENGTH 256
+
+/**
+ * @def SUPER_SEQS_COUNT
+ * @brief Nombre de superinstructions disposant d'un gestionnaire.
+ * 
+ */
+#define SUPER_SEQS_COUNT (F_OPS_COUNT - FLAT_BASE_OPS)
+
+#define SUPER_PAIR_SEQ(a, b) { 2, { F_##a, F_##b, F_END } },
+#define SUPER_TRIPLE_SEQ(a, b, c) { 3, { F_##a, F_##b, F_##c } },
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @typedef Superseq
+ * @struct Superseq
+ * @brief Structure représentant la suite d'instructions de base exécutée par
+ * une superinstruction.
+ * 
+ */
+typedef struct Superseq {
+	int length;		///< Nombre d'instructions de la suite (2 ou 3).
+	int ops[3];		///< Codes d'opérations de la suite.
+} Superseq;
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @var Superseq super_seqs[]
+ * @brief Suite de chaque superinstruction, dans l'ordre de leurs codes
+ * d'opérations (à partir de FLAT_BASE_OPS).
+ * 
+ */
+static const Superseq super_seqs[SUPER_SEQS_COUNT] = {
+	FLAT_SUPER_PAIRS(SUPER_PAIR_SEQ)
+	FLAT_SUPER_TRIPLES(SUPER_TRIPLE_SEQ)
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne true si l'instruction de code donné passe toujours la main
+ * à l'instruction suivante (ni saut, ni fin).
+ * 
+ * @param op Le code d'opération (de base).
+ * @return bool Vaut true si l'instruction n'est pas un saut.
+ */
+static bool super_falls_through(int op) {
+	return op != F_JZ && op != F_JNZ && op != F_END;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nombre d'instructions exécutées par une instruction
+ * (de base ou superinstruction).
+ * 
+ * @param op Le code d'opération.
+ * @return int Le nombre d'instructions de la suite.
+ */
+static int super_length(int op) {
+	return (op < FLAT_BASE_OPS) ? 1 : super_seqs[op - FLAT_BASE_OPS].length;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le compteur du profil associé à une suite.
+ * 
+ * @param profilep Le pointeur vers le profil.
+ * @param seq La suite.
+ * @return long* Le compteur de la suite.
+ */
+static long *super_counter(Superprofile *profilep, const Superseq *seq) {
+	if (seq->length == 2) return &profilep->pairs[seq->ops[0]][seq->ops[1]];
+
+	return &profilep->triples[seq->ops[0]][seq->ops[1]][seq->ops[2]];
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le code d'opération de base de nom donné.
+ * 
+ * @param name Le nom de l'opération (voir FLAT_OPS_STRINGS).
+ * @return int Le code d'opération, ou -1 si le nom est inconnu.
+ */
+static int super_op(char *name) {
+	char *ops[] = FLAT_OPS_STRINGS;
+
+	for (int op = 0; op < FLAT_BASE_OPS; op++)
+		if (strcmp(ops[op], name) == 0) return op;
+
+	return -1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Charge un profil depuis le fichier donné.
+ * 
+ * @param profilep Le pointeur vers le profil à remplir.
+ * @param path Le chemin du fichier.
+ * @param required Vaut true si l'absence du fichier est une erreur ; sinon,
+ * le profil est simplement vide.
+ * 
+ * @note Une ligne mal formée provoquera une erreur.
+ * @note Chaque ligne est de la forme "runs <n>", "total <n>", ou bien deux ou
+ * trois noms d'opérations suivis du compteur de la suite ("ADD MOVE 42").
+ */
+void super_load(Superprofile *profilep, char *path, bool required) {
+	char line[SUPER_LINE_LENGTH], *words[4], *end;
+	int ops[3], count, number = 0;
+	long value;
+	FILE *in;
+
+	memset(profilep, 0, sizeof(Superprofile));
+
+	in = fopen(path, "r");
+	if (in == NULL) {
+		if (required || errno != ENOENT)
+			merror("super_load() : Impossible d'ouvrir le profil [%s] ! [%s]",
+				   path, strerror(errno));
+		return;
+	}
+
+	while (fgets(line, SUPER_LINE_LENGTH, in) != NULL) {
+		number++;
+		if (line[0] == '#') continue;
+
+		count = 0;
+		for (char *word = strtok(line, " \t\r\n"); word != NULL;
+			 word = strtok(NULL, " \t\r\n")) {
+			if (count == 4)
+				merror("super_load() : Ligne %d du profil [%s] incorrecte !",
+					   number, path);
+			words[count++] = word;
+		}
+		if (count == 0) continue;
+
+		value = strtol(words[count - 1], &end, 10);
+		if (count < 2 || *end != '\0' || value < 0)
+			merror("super_load() : Ligne %d du profil [%s] incorrecte !",
+				   number, path);
+
+		if (count == 2 && strcmp(words[0], "runs") == 0) {
+			profilep->runs = value;
+			continue;
+		}
+		if (count == 2 && strcmp(words[0], "total") == 0) {
+			profilep->total = value;
+			continue;
+		}
+
+		for (int i = 0; i < count - 1; i++)
+			if ((ops[i] = super_op(words[i])) < 0)
+				merror("super_load() : Opération [%s] inconnue (ligne %d du"
+					   " profil [%s]) !", words[i], number, path);
+
+		if (count == 3) profilep->pairs[ops[0]][ops[1]] = value;
+		else profilep->triples[ops[0]][ops[1]][ops[2]] = value;
+	}
+
+	fclose(in);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Écrit un profil dans le fichier donné.
+ * 
+ * @param profilep Le pointeur vers le profil à écrire.
+ * @param path Le chemin du fichier.
+ */
+void super_save(Superprofile *profilep, char *path) {
+	char *ops[] = FLAT_OPS_STRINGS;
+	FILE *out = fopen(path, "w");
+
+	if (out == NULL)
+		merror("super_save() : Impossible d'écrire le profil [%s] ! [%s]",
+			   path, strerror(errno));
+
+	fprintf(out, "%s\n", SUPER_PROFILE_HEADER);
+	fprintf(out, "runs %ld\ntotal %ld\n", profilep->runs, profilep->total);
+
+	for (int a = 0; a < FLAT_BASE_OPS; a++)
+		for (int b = 0; b < FLAT_BASE_OPS; b++) {
+			if (profilep->pairs[a][b] != 0)
+				fprintf(out, "%s %s %ld\n", ops[a], ops[b],
+						profilep->pairs[a][b]);
+
+			for (int c = 0; c < FLAT_BASE_OPS; c++)
+				if (profilep->triples[a][b][c] != 0)
+					fprintf(out, "%s %s %s %ld\n", ops[a], ops[b], ops[c],
+							profilep->triples[a][b][c]);
+		}
+
+	fclose(out);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute à un profil les suites exécutées par un programme, à partir
+ * du nombre d'exécutions de chacune de ses instructions.
+ * 
+ * @param profilep Le pointeur vers le profil.
+ * @param prog Le programme exécuté (sans superinstructions).
+ * @param exec Le nombre d'exécutions de chaque instruction.
+ * 
+ * @note Une instruction qui n'est pas un saut passe toujours la main à la
+ * suivante : la suite qu'elle commence est donc exécutée d'un seul tenant
+ * autant de fois qu'elle.
+ */
+void super_record(Superprofile *profilep, Flatprog prog, long *exec) {
+	Flatinst *code = prog.code;
+
+	profilep->runs++;
+
+	for (int i = 0; i < prog.length; i++) {
+		profilep->total += exec[i];
+
+		if (exec[i] == 0 || !super_falls_through(code[i].op)
+			|| i + 1 >= prog.length || code[i + 1].op == F_END)
+			continue;
+
+		profilep->pairs[code[i].op][code[i + 1].op] += exec[i];
+
+		if (!super_falls_through(code[i + 1].op) || i + 2 >= prog.length
+			|| code[i + 2].op == F_END)
+			continue;
+
+		profilep->triples[code[i].op][code[i + 1].op][code[i + 2].op]
+			+= exec[i];
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retient, d'après le profil, les superinstructions qui évitent le
+ * plus de distributions.
+ * 
+ * @param profilep Le pointeur vers le profil.
+ * @return Superset Les superinstructions retenues.
+ * 
+ * @note Seules les suites qui disposent d'un gestionnaire dans la machine
+ * virtuelle (voir FLAT_SUPER_PAIRS et FLAT_SUPER_TRIPLES) sont candidates.
+ * @note Une suite de n instructions exécutée k fois évite k * (n - 1)
+ * distributions.
+ */
+Superset super_select(Superprofile *profilep) {
+	Superset set = { .length = 0 };
+	long gain;
+	int j;
+
+	for (int i = 0; i < SUPER_SEQS_COUNT; i++) {
+		gain = *super_counter(profilep, &super_seqs[i])
+			   * (super_seqs[i].length - 1);
+		if (gain == 0) continue;
+
+		// Insertion dans la liste triée par gain décroissant.
+		for (j = set.length; j > 0 && set.gains[j - 1] < gain; j--) {
+			if (j == SUPER_MAX_SELECTED) continue;
+			set.ops[j] = set.ops[j - 1];
+			set.gains[j] = set.gains[j - 1];
+		}
+		if (j == SUPER_MAX_SELECTED) continue;
+
+		set.ops[j] = FLAT_BASE_OPS + i;
+		set.gains[j] = gain;
+		if (set.length < SUPER_MAX_SELECTED) set.length++;
+	}
+
+	return set;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Remplace dans un programme les suites retenues par leurs
+ * superinstructions.
+ * 
+ * @param progp Le pointeur vers le programme.
+ * @param set Les superinstructions retenues.
+ * @return int Le nombre de suites remplacées.
+ * 
+ * @note Le programme est parcouru une seule fois, de gauche à droite ; à
+ * chaque instruction, la première superinstruction (par gain) qui convient
+ * est utilisée.
+ * @note Seul le code d'opération de la première instruction de la suite est
+ * remplacé (voir Flatinst).
+ */
+int super_fuse(Flatprog *progp, Superset set) {
+	Flatinst *code = progp->code;
+	const Superseq *seq = NULL;
+	int sites = 0, k, j;
+
+	for (int i = 0; i < progp->length;) {
+		for (k = 0; k < set.length; k++) {
+			seq = &super_seqs[set.ops[k] - FLAT_BASE_OPS];
+			if (i + seq->length > progp->length) continue;
+
+			for (j = 0; j < seq->length && code[i + j].op == seq->ops[j]; j++);
+			if (j == seq->length) break;
+		}
+
+		if (k == set.length) {
+			i++;
+			continue;
+		}
+
+		code[i].op = set.ops[k];
+		i += seq->length;
+		sites++;
+	}
+
+	return sites;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime, pour un programme exécuté, le nombre de distributions avant
+ * fusion puis après chaque fusion retenue.
+ * 
+ * @param prog Le programme exécuté (sans superinstructions).
+ * @param exec Le nombre d'exécutions de chaque instruction.
+ * @param set Les superinstructions retenues.
+ * @param out La sortie sur laquelle imprimer le rapport.
+ * 
+ * @note Les fusions sont cumulées : la ligne de la k-ième superinstruction
+ * donne les distributions du programme fusionné avec les k premières. Les
+ * instructions internes d'une suite n'étant jamais la cible d'un saut, elles
+ * sont exécutées exactement autant de fois que la première.
+ */
+void super_report(Flatprog prog, long *exec, Superset set, FILE *out) {
+	char *ops[] = FLAT_OPS_STRINGS;
+	Flatprog fused = prog;
+	Superset prefix = set;
+	long before = 0, after;
+	int sites;
+
+	for (int i = 0; i < prog.length; i++) before += exec[i];
+
+	fprintf(out, "- Superinstructions : %ld distributions sans fusion\n",
+			before);
+
+	fused.code = (Flatinst *)malloc(prog.length * sizeof(Flatinst));
+	if (fused.code == NULL)
+		merror("super_report() : Échec de l'allocation de mémoire à 'code' !"
+			   " [%s]", strerror(errno));
+
+	for (int k = 1; k <= set.length; k++) {
+		memcpy(fused.code, prog.code, prog.length * sizeof(Flatinst));
+		prefix.length = k;
+		sites = super_fuse(&fused, prefix);
+
+		after = 0;
+		for (int i = 0; i < fused.length; i += super_length(fused.code[i].op))
+			after += exec[i];
+
+		fprintf(out, "  + %-14s : %ld distributions (%d site(s), -%.1f %%)\n",
+				ops[set.ops[k - 1]], after, sites,
+				before ? 100.0 * (before - after) / before : 0.0);
+	}
+
+	free(fused.code);
+}
+
+/* -------------------------------------------------------------------------- */
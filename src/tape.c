@@ -0,0 +1,303 @@
+/**
+ * @file tape.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant la bande de données de la machine virtuelle :
+ * une zone virtuelle réservée (mmap) dont la partie engagée est entourée de
+ * pages de garde, agrandie à la demande par un gestionnaire de SIGSEGV.
+ * @date 2024-05-15
+ * 
+ * 
+ */
+#define _DEFAULT_SOURCE
+#include "tape.h"
+
+#if TAPE_GUARDED
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                             VARIABLES GLOBALES                             */
+/* -------------------------------------------------------------------------- */
+
+#if TAPE_GUARDED
+
+/**
+ * @var sigjmp_buf tape_escape
+ * @brief Point de reprise, posé par vm_dispatch (vm.c), où le gestionnaire de
+ * SIGSEGV rend la main après un accès hors de la bande.
+ * 
+ */
+sigjmp_buf tape_escape;
+
+#endif
+
+/*
+ * Disposition de la zone réservée :
+ * 
+ *   | garde | engagée (committed) | réservée ... | garde |
+ *   ^ tape_base                                  ^ tape_end
+ *           ^ tape_start
+ * 
+ * Seule la partie engagée est accessible (PROT_READ | PROT_WRITE). Un accès à
+ * la partie réservée engage de nouvelles pages ; un accès à l'une des gardes
+ * (TAPE_GUARD_SIZE octets chacune, soit plus que la portée d'un déplacement
+ * suivi d'un accès décalé depuis la bande) est signalé comme hors limites.
+ */
+
+/**
+ * @var char * tape_base
+ * @brief Début de la zone virtuelle réservée (NULL si aucune bande).
+ * 
+ */
+static char *tape_base;
+
+/**
+ * @var char * tape_start
+ * @brief Première case de la bande.
+ * 
+ */
+static char *tape_start;
+
+/**
+ * @var char * tape_end
+ * @brief Fin de la zone virtuelle réservée.
+ * 
+ */
+static char *tape_end;
+
+/**
+ * @var size_t tape_committed
+ * @brief Nombre d'octets engagés à partir de la première case.
+ * 
+ */
+static size_t tape_committed;
+
+/**
+ * @var int tape_cell_size
+ * @brief Taille d'une case (1, 2 ou 4 octets).
+ * 
+ */
+static int tape_cell_size;
+
+/**
+ * @var int tape_grows
+ * @brief Nombre d'agrandissements de la bande.
+ * 
+ */
+static int tape_grows;
+
+/**
+ * @var volatile long tape_fault_cell
+ * @brief Position (en cases) du dernier accès hors de la bande.
+ * 
+ */
+static volatile long tape_fault_cell;
+
+#if TAPE_GUARDED
+
+/**
+ * @var struct sigaction tape_previous
+ * @brief Traitement de SIGSEGV en place avant l'allocation de la bande.
+ * 
+ */
+static struct sigaction tape_previous;
+
+/**
+ * @var stack_t tape_altstack
+ * @brief Pile de secours du gestionnaire de SIGSEGV (débordement de la pile
+ * d'appel).
+ * 
+ */
+static stack_t tape_altstack;
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+#if TAPE_GUARDED
+
+/**
+ * @brief Gestionnaire de SIGSEGV : agrandit la bande si l'adresse fautive se
+ * situe dans la réserve, signale un accès hors limites si elle se situe dans
+ * l'une des gardes.
+ * 
+ * @param sig Le numéro du signal.
+ * @param info Les informations du signal (adresse fautive).
+ * @param context Le contexte interrompu (inutilisé).
+ * 
+ * @note L'instruction fautive est réexécutée au retour du gestionnaire. Une
+ * faute étrangère à la bande rétablit le traitement par défaut et se répète.
+ * @note Les erreurs ne sont pas signalées ici (merror n'est pas sûr dans un
+ * gestionnaire de signal) : le gestionnaire saute (siglongjmp) vers
+ * tape_escape avec leur code, puis tape_report les signale.
+ */
+static void tape_fault(int sig, siginfo_t *info, void *context) {
+	char *addr = (char *)info->si_addr;
+	size_t page = (size_t)sysconf(_SC_PAGESIZE), grown, need;
+
+	(void)context;
+
+	if (tape_base == NULL || addr < tape_base
+		|| addr >= tape_end + TAPE_GUARD_SIZE) {
+		signal(sig, SIG_DFL);
+		return;
+	}
+
+	if (addr < tape_start || addr >= tape_end) {
+		tape_fault_cell = (long)((addr - tape_start) / tape_cell_size);
+		siglongjmp(tape_escape, TAPE_OUT_OF_BOUNDS);
+	}
+
+	// Engagement (par doublement) des pages jusqu'à l'adresse fautive.
+	need = (size_t)(addr - tape_start) + 1;
+	grown = tape_committed;
+	while (grown < need) grown *= 2;
+	grown = (grown + page - 1) / page * page;
+	if (grown > (size_t)(tape_end - tape_start))
+		grown = (size_t)(tape_end - tape_start);
+
+	if (mprotect(tape_start + tape_committed, grown - tape_committed,
+				 PROT_READ | PROT_WRITE) != 0)
+		siglongjmp(tape_escape, TAPE_GROW_FAILED);
+
+	tape_committed = grown;
+	tape_grows++;
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Alloue une bande de données initialisée à zéro.
+ * 
+ * @param cells Le nombre de cases initialement engagées.
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @return void* La première case de la bande.
+ * 
+ * @note Un échec d'allocation provoquera une erreur.
+ * @note Une seule bande peut être allouée à la fois.
+ * @note Sans TAPE_GUARDED, la bande est un tableau de taille fixe, sans
+ * protection.
+ */
+void *tape_init(size_t cells, int size) {
+#if TAPE_GUARDED
+	struct sigaction action;
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	void *base;
+
+	tape_cell_size = size;
+	tape_grows = 0;
+	tape_committed = (cells * size + page - 1) / page * page;
+	if (tape_committed > TAPE_RESERVE_SIZE)
+		merror("tape_init() : Bande initiale trop grande !");
+
+	// Réservation (sans accès), puis engagement de la partie initiale. Les
+	// pages anonymes sont remplies de zéros par le système.
+	base = mmap(NULL, 2 * TAPE_GUARD_SIZE + TAPE_RESERVE_SIZE, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED)
+		merror("tape_init() : Échec de la réservation de la bande ! [%s]",
+			   strerror(errno));
+
+	tape_base = base;
+	tape_start = tape_base + TAPE_GUARD_SIZE;
+	tape_end = tape_start + TAPE_RESERVE_SIZE;
+
+	if (mprotect(tape_start, tape_committed, PROT_READ | PROT_WRITE) != 0)
+		merror("tape_init() : Échec de l'engagement de la bande ! [%s]",
+			   strerror(errno));
+
+	// Pile de secours, puis gestionnaire de SIGSEGV.
+	tape_altstack.ss_sp = malloc(SIGSTKSZ);
+	tape_altstack.ss_size = SIGSTKSZ;
+	tape_altstack.ss_flags = 0;
+	if (tape_altstack.ss_sp != NULL) sigaltstack(&tape_altstack, NULL);
+
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = tape_fault;
+	action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(SIGSEGV, &action, &tape_previous) != 0)
+		merror("tape_init() : Échec de l'installation du gestionnaire ! [%s]",
+			   strerror(errno));
+
+	return tape_start;
+#else
+	tape_cell_size = size;
+	tape_committed = cells * size;
+	tape_start = (char *)calloc(cells, size);
+	if (tape_start == NULL)
+		merror("tape_init() : Échec de l'allocation de mémoire à la bande !"
+			   " [%s]", strerror(errno));
+
+	tape_base = tape_start;
+	return tape_start;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime l'état de la bande de données (cases engagées et
+ * agrandissements) sur la sortie donnée.
+ * 
+ * @param out La sortie sur laquelle imprimer l'état.
+ */
+void tape_print(FILE *out) {
+	fprintf(out, "- Bande de données : %zu cases engagées, %d agrandissement(s)"
+			"\n", tape_committed / tape_cell_size, tape_grows);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Signale l'erreur ayant interrompu l'exécution sur la bande de données
+ * (code rendu par sigsetjmp(tape_escape, 1)).
+ * 
+ * @param code Le code de l'erreur (TAPE_OUT_OF_BOUNDS ou TAPE_GROW_FAILED).
+ * 
+ * @note Cette fonction provoquera une erreur.
+ */
+void tape_report(int code) {
+	if (code == TAPE_GROW_FAILED)
+		merror("tape_fault() : Échec de l'agrandissement de la bande !");
+
+	merror("Accès hors de la bande de données à la position %ld !",
+		   tape_fault_cell);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la bande de données et rétablit le traitement par défaut de
+ * SIGSEGV.
+ * 
+ */
+void tape_free() {
+	if (tape_base == NULL) return;
+
+#if TAPE_GUARDED
+	sigaction(SIGSEGV, &tape_previous, NULL);
+
+	if (tape_altstack.ss_sp != NULL) {
+		tape_altstack.ss_flags = SS_DISABLE;
+		sigaltstack(&tape_altstack, NULL);
+		free(tape_altstack.ss_sp);
+		tape_altstack.ss_sp = NULL;
+	}
+
+	munmap(tape_base, 2 * TAPE_GUARD_SIZE + TAPE_RESERVE_SIZE);
+#else
+	free(tape_base);
+#endif
+
+	tape_base = tape_start = tape_end = NULL;
+	tape_committed = 0;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,129 @@
+/**
+ * @file tier.c
+ * @author Mourtaza Akil (akilmourtaza.fr)
+ * @brief Module implémentant l'exécution par niveaux : les boucles d'un
+ * programme linéaire sont d'abord interprétées, puis compilées à la volée
+ * (JIT) lorsque leur nombre de retours arrière dépasse un seuil.
+ * @date 2024-05-13
+ * 
+ * 
+ */
+#include "tier.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialise l'exécution par niveaux d'un programme linéaire.
+ * 
+ * @param progp Le pointeur vers le programme à exécuter.
+ * @param threshold Le seuil de compilation (en retours arrière).
+ * @param size La taille d'une case (1, 2 ou 4 octets).
+ * @param count Vaut true si les itérations du code machine sont comptées.
+ * @return Tier L'état initial de l'exécution par niveaux.
+ */
+Tier tier_init(Flatprog *progp, long threshold, int size, bool count) {
+	Tier tier = {
+		.progp = progp, .threshold = threshold, .size = size, .count = count,
+		.stats = { .interpreted = 0, .compiled = 0, .entries = 0, .native = 0 }
+	};
+
+	tier.loops = (Tierloop *)calloc(progp->length, sizeof(Tierloop));
+	if (tier.loops == NULL)
+		merror("tier_init() : Échec de l'allocation de mémoire à 'loops' !"
+			   " [%s]", strerror(errno));
+
+	return tier;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Enregistre un retour arrière de la boucle donnée et la compile si
+ * elle atteint le seuil.
+ * 
+ * @param tierp Le pointeur vers l'état de l'exécution par niveaux.
+ * @param head L'indice de l'instruction F_JZ de la boucle.
+ * @return bool Vaut true si la boucle dispose d'un code machine.
+ * 
+ * @note La boucle est compilée depuis son noeud dans l'arbre : le code machine
+ * englobe les boucles internes, qu'elles aient déjà été compilées ou non.
+ */
+bool tier_backedge(Tier *tierp, int head) {
+	Tierloop *loop = &tierp->loops[head];
+
+	if (loop->code.code != NULL) return true;
+
+	tierp->stats.interpreted++;
+	if (++loop->backedges < tierp->threshold) return false;
+
+	loop->code = jit_loop(tierp->progp->nodes[head], tierp->size,
+						  tierp->count);
+	tierp->stats.compiled++;
+
+	return loop->code.code != NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Exécute le code machine de la boucle donnée à partir de la case
+ * pointée, au début d'une itération.
+ * 
+ * @param tierp Le pointeur vers l'état de l'exécution par niveaux.
+ * @param head L'indice de l'instruction F_JZ de la boucle (compilée).
+ * @param ptr La case pointée.
+ * @return void* La case pointée à la sortie de la boucle.
+ * 
+ * @note Le code machine reprend au test de la case pointée : il peut donc
+ * prendre le relais de l'interpréteur au milieu de la boucle (remplacement
+ * sur la pile, 'OSR'), la bande de données étant partagée.
+ */
+void *tier_run(Tier *tierp, int head, void *ptr) {
+	tierp->stats.entries++;
+
+	return jit_run(tierp->loops[head].code, ptr,
+				   tierp->count ? &tierp->stats.native : NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime les compteurs d'exécution de chaque niveau sur la sortie
+ * donnée.
+ * 
+ * @param tier L'état de l'exécution par niveaux.
+ * @param out La sortie sur laquelle imprimer les compteurs.
+ */
+void tier_print(Tier tier, FILE *out) {
+	fprintf(out, "- Exécution par niveaux (seuil : %ld retours arrière)\n",
+			tier.threshold);
+	fprintf(out, "  + Niveau 0 (VM)    : %ld retours arrière interprétés\n",
+			tier.stats.interpreted);
+	fprintf(out, "  + Niveau 1 (natif) : %d boucle(s) compilée(s), %ld entrées",
+			tier.stats.compiled, tier.stats.entries);
+	if (tier.count)
+		fprintf(out, ", %ld itérations", tier.stats.native);
+	fprintf(out, "\n");
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Libère la mémoire allouée à l'exécution par niveaux (dont le code
+ * machine des boucles compilées).
+ * 
+ * @param tierp Le pointeur vers l'état à libérer.
+ */
+void tier_free(Tier *tierp) {
+	if (tierp == NULL || tierp->loops == NULL) return;
+
+	for (int i = 0; i < tierp->progp->length; i++)
+		jit_free(&tierp->loops[i].code);
+
+	free(tierp->loops);
+	tierp->loops = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -39,6 +39,25 @@ void print_simple_inst(FILE *out, char *inst, int count, int depth) {
 	}
 }
 
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime une instruction formatée, précédée de son indentation.
+ * 
+ * @param out Le fichier de sortie.
+ * @param depth La profondeur (indentation) de l'instruction.
+ * @param format Le format de l'instruction.
+ * @param ... Les arguments à placer dans le format de l'instruction.
+ */
+void print_inst(FILE *out, int depth, char *format, ...) {
+	va_list args;
+
+	print_indent(out, depth);
+	va_start(args, format);
+		vfprintf(out, format, args);
+	va_end(args);
+}
+
 /* ---------------------------------- Main ---------------------------------- */
 
 /**
@@ -49,6 +68,7 @@ void print_simple_inst(FILE *out, char *inst, int count, int depth) {
  * @param ... Les arguments à placer dans le format du message.
  * 
  * @see HELP_NOTICE_FORMAT
+ * @see HELP_NOTICE_OPTIONS
  */
 void usage(char *program, char *format, ...) {
     va_list args;
@@ -66,6 +86,7 @@ void usage(char *program, char *format, ...) {
 
 	// Notice
     printf(HELP_NOTICE_FORMAT, program);
+    fputs(HELP_NOTICE_OPTIONS, stdout);
 
     exit(EXIT_FAILURE);
 }
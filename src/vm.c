@@ -7,111 +7,196 @@
  * 
  * 
  */
+#define _DEFAULT_SOURCE
 #include "vm.h"
 
+#if TAPE_GUARDED
+#include <setjmp.h>
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*                             VARIABLES GLOBALES                             */
 /* -------------------------------------------------------------------------- */
 
-/**
- * @var int * data_stack
- * @brief Pile de données de l'interpréteur Brainfuck.
- */
-static int *data_stack;
+extern Options options;
+
+#if TAPE_GUARDED
+extern sigjmp_buf tape_escape;
+#endif
 
 /* -------------------------------------------------------------------------- */
+/*                                  FONCTIONS                                 */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Macros de distribution des instructions du programme linéaire.
+ *
+ * - VM_BEGIN  : début de la boucle de distribution.
+ * - VM_OP     : étiquette du gestionnaire d'un code d'opération.
+ * - VM_NEXT   : passage à l'instruction suivante.
+ * - VM_END    : fin de la boucle de distribution.
+ *
+ * En mode 'direct threading', chaque gestionnaire saute directement vers le
+ * gestionnaire de l'instruction suivante, sans repasser par un 'switch'
+ * central : chaque saut indirect dispose ainsi de sa propre prédiction.
+ */
+#if VM_THREADED_DISPATCH
+	#define VM_BEGIN()	goto *handlers[pc->op];
+	#define VM_OP(op)	L_##op
+	#define VM_NEXT()	goto *handlers[(++pc)->op]
+	#define VM_END()
+#else
+	#define VM_BEGIN()	for (;;) switch (pc->op) {
+	#define VM_OP(op)	case op
+	#define VM_NEXT()	pc++; continue
+	#define VM_END()	default: \
+		merror("execute_flat() : 'pc->op' inconnu !"); }
+#endif
 
 /**
- * @var int * ptr
- * @brief Pointeur de données de l'interpréteur Brainfuck.
+ * @brief Ajoute au profil FLAG_PROFILE_RECORD les suites exécutées par un
+ * programme, puis imprime (avec FLAG_STATS) les distributions évitées par
+ * chaque superinstruction retenue.
  * 
+ * @param prog Le programme exécuté (sans superinstructions).
+ * @param exec Le nombre d'exécutions de chaque instruction.
+ * 
+ * @note Les superinstructions du rapport sont celles du profil
+ * FLAG_PROFILE_FUSE s'il est donné, celles du profil enregistré sinon.
  */
-static int *ptr;
+static void vm_profile(Flatprog prog, long *exec) {
+	Superprofile profile;
+
+	super_load(&profile, options.profile_out, false);
+	super_record(&profile, prog, exec);
+	super_save(&profile, options.profile_out);
+
+	if (!options.stats) return;
+
+	if (options.profile_in != NULL)
+		super_load(&profile, options.profile_in, true);
+	super_report(prog, exec, super_select(&profile), stderr);
+}
 
-/* -------------------------------------------------------------------------- */
-/*                                  FONCTIONS                                 */
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Initialise la pile de données de l'interpréteur Brainfuck.
+ * @brief Remplace dans un programme les suites retenues d'après le profil
+ * FLAG_PROFILE_FUSE par leurs superinstructions.
+ * 
+ * @param progp Le pointeur vers le programme.
  * 
+ * @note Sans profil, le programme n'est pas modifié.
+ * @note Avec FLAG_STATS, le nombre de sites de chaque superinstruction est
+ * affiché : les gains estimés par le profil se recouvrent (une même
+ * instruction appartient à plusieurs suites) et ne s'additionnent pas ; les
+ * distributions évitées sont données par super_report sous
+ * FLAG_PROFILE_RECORD.
  */
-static void init_stack() {
-	data_stack = (int *)calloc(DATA_STACK_SIZE, sizeof(int));
-	ptr = data_stack;
+static void vm_fuse(Flatprog *progp) {
+	char *ops[] = FLAT_OPS_STRINGS;
+	Superprofile profile;
+	Superset set;
+	int sites;
+
+	if (options.profile_in == NULL) return;
+
+	super_load(&profile, options.profile_in, true);
+	set = super_select(&profile);
+	sites = super_fuse(progp, set);
+
+	if (!options.stats) return;
+
+	fprintf(stderr, "- Superinstructions (profil [%s]) : %d site(s) fusionné(s)"
+			"\n", options.profile_in, sites);
+	for (int k = 0; k < set.length; k++) {
+		// Seule la première instruction d'une suite porte la superinstruction.
+		sites = 0;
+		for (int i = 0; i < progp->length; i++)
+			if (progp->code[i].op == set.ops[k]) sites++;
+
+		fprintf(stderr, "  + %-14s : %d site(s)\n", ops[set.ops[k]], sites);
+	}
 }
 
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Libère la mémoire allouée à la pile de données de l'interpréteur
- * Brainfuck.
+ * @brief Recopie sur la bande de données les cases initialisées par
+ * l'évaluation partielle du programme.
  * 
+ * @param pe Le résultat de l'évaluation partielle.
+ * @param tape La première case de la bande contiguë (si 'sparsep' est NULL).
+ * @param sparsep Le pointeur vers la bande creuse, ou NULL.
  */
-static void free_stack() {
-	free(data_stack);
-	data_stack = NULL;
-	ptr = NULL;
+static void vm_preload(Peval pe, void *tape, Sparsetape *sparsep) {
+	int size = options.cell_bits / 8;
+	void *cell;
+
+	for (long i = 0; i < pe.cells; i++) {
+		if (pe.tape[i] == 0) continue;
+
+		cell = (sparsep != NULL) ? sparse_cell(sparsep, i)
+								 : (char *)tape + i * size;
+		switch (size) {
+			case 1:  *(uint8_t *)cell = (uint8_t)pe.tape[i];   break;
+			case 2:  *(uint16_t *)cell = (uint16_t)pe.tape[i]; break;
+			default: *(uint32_t *)cell = pe.tape[i];
+		}
+	}
 }
 
 /* -------------------------------------------------------------------------- */
 
+#if VM_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+// Instanciation des moteurs pour chaque largeur de case (voir vm_engine.h).
+#define VM_CELL uint8_t
+#define VM_SUFFIX 8
+#include "vm_engine.h"
+
+#define VM_CELL uint16_t
+#define VM_SUFFIX 16
+#include "vm_engine.h"
+
+#define VM_CELL uint32_t
+#define VM_SUFFIX 32
+#include "vm_engine.h"
+
+#if VM_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+/* -------------------------------------------------------------------------- */
+
 /**
- * @brief Exécute une instruction Brainfuck représentée sous la forme d'un
- * arbre de syntaxe abstraite (AST).
+ * @brief Exécute le reste d'un programme avec le moteur de la largeur de case
+ * choisie.
  * 
- * @param tree L'arbre de syntaxe abstraite (AST) de l'instruction.
+ * @param pe L'évaluation partielle du préfixe (reste et position du pointeur).
+ * @param blocks Les blocs de base du reste.
+ * @param tape La bande de données (NULL si la bande est creuse).
+ * @param sparsep La bande creuse (NULL si la bande n'est pas creuse).
  * 
- * @note Cette fonction exécute en chaîne toutes les instructions qui suivent
- * l'instruction donnée.
+ * @note Le point de reprise tape_escape est posé ici : une erreur détectée par
+ * le gestionnaire de SIGSEGV de la bande (accès hors limites) y est signalée.
  */
-static void execute_instruction(Asttree tree) {
-	int ast_type, count;
-
-	if (ast_is_empty(tree)) return;
-
-	// Le champ 'numéro lexical' est utilisé pour indiquer le nombre
-	// d'opérations simples successives.
-	count = tree->id_lex;
-
-	ast_type = tree->type;
-	switch (ast_type) {
-		case A_LOOP:
-			while (*ptr != 0)
-				execute_instruction(tree->son);
-			execute_instruction(tree->little_brother);
-			break;
-		case A_INC:
-			(*ptr) += count;
-			execute_instruction(tree->little_brother);
-			break;
-		case A_DEC:
-			(*ptr) -= count;
-			execute_instruction(tree->little_brother);
-			break;
-		case A_LEFT:
-			ptr -= count;
-			execute_instruction(tree->little_brother);
-			break;
-		case A_RIGHT:
-			ptr += count;
-			execute_instruction(tree->little_brother);
-			break;
-		case A_PUT:
-			for (int i = 0;  i < count; i++)
-				putchar(*ptr);
-
-			execute_instruction(tree->little_brother);
-			break;
-		case A_GET:
-			for (int i = 0; i < count; i++)
-				*ptr = getchar();
-
-			EMPTY_BUFFER();
-			execute_instruction(tree->little_brother);
-			break;
-		default:
-			merror("execute_instruction() : 'tree->type' inconnu !");
+static void vm_dispatch(Peval pe, Block *blocks, void *tape,
+						Sparsetape *sparsep) {
+#if TAPE_GUARDED
+	int fault;
+
+	if (tape != NULL && (fault = sigsetjmp(tape_escape, 1)) != 0)
+		tape_report(fault);
+#endif
+
+	switch (options.cell_bits) {
+		case 8:  execute_8(pe.rest, blocks, tape, pe.ptr, sparsep);  break;
+		case 16: execute_16(pe.rest, blocks, tape, pe.ptr, sparsep); break;
+		default: execute_32(pe.rest, blocks, tape, pe.ptr, sparsep);
 	}
 }
 
@@ -122,11 +207,119 @@ static void execute_instruction(Asttree tree) {
  * syntaxe abstraite (AST).
  * 
  * @param tree L'arbre de syntaxe abstraite (AST) à exécuter.
+ * 
+ * @note Par défaut, l'arbre est d'abord converti en blocs de base (voir
+ * block.h), puis abaissé en programme linéaire. Le drapeau FLAG_TREE_WALKER
+ * permet de conserver l'exécution par parcours de l'arbre, notamment pour
+ * comparer les moteurs, le drapeau FLAG_JIT de
+ * compiler l'arbre en code machine, et le drapeau FLAG_TIERED de ne compiler
+ * que les boucles qui dépassent le seuil d'exécution par niveaux.
+ * @note Le drapeau FLAG_CELL_BITS choisit l'instance des moteurs (cases de 8,
+ * 16 ou 32 bits, arithmétique modulaire).
+ * @note La bande compte initialement les cases nécessaires au programme si
+ * elles sont bornées (voir bounds.h), DATA_STACK_SIZE sinon ; elle est
+ * agrandie à la demande et les accès hors limites sont détectés par les pages
+ * de garde (voir tape.h), sans test dans les moteurs.
+ * @note Avec FLAG_PROFILE_RECORD, le programme est exécuté par un moteur qui
+ * compte ses instructions afin d'enregistrer un profil ; avec
+ * FLAG_PROFILE_FUSE, la VM fusionne les suites les plus fréquentes du profil
+ * donné en superinstructions (voir super.h).
+ * @note Avec FLAG_PEVAL, le préfixe du programme qui précède la première
+ * lecture est d'abord évalué (voir peval.h) : seul le reste est exécuté, sur
+ * la bande laissée par le préfixe.
+ * @note Avec FLAG_SPARSE, la bande est creuse (voir sparse.h) : elle s'étend
+ * dans les deux sens et seules les pages touchées occupent de la mémoire.
  */
 void execute_program(Asttree tree) {
-	init_stack();
-	execute_instruction(tree);
-	free_stack();
+	Sparsetape sparse, *sparsep = NULL;
+	void *tape = NULL;
+	Block *blocks;
+	Blockstats bs;
+	Bounds b;
+	Peval pe = { .rest = tree, .tape = NULL, .cells = 0, .ptr = 0,
+				 .output = NULL, .length = 0 };
+
+	if (options.sparse && options.profile_out != NULL)
+		mwarning("execute_program() : Le profil n'est pas enregistré sur la"
+				 " bande creuse.");
+	if (options.sparse
+		&& (options.tree_walker || options.jit || options.tier_threshold > 0))
+		mwarning("execute_program() : La bande creuse n'est exécutée que par"
+				 " la VM, drapeaux -t, -j et -T ignorés.");
+	else if ((options.jit || options.tier_threshold > 0) && !JIT_AVAILABLE)
+		mwarning("execute_program() : Compilation à la volée indisponible sur"
+				 " cette plate-forme, utilisation de la VM.");
+
+	// Préfixe indépendant de l'entrée : sa sortie est écrite d'un bloc.
+	if (options.peval_budget > 0) {
+		pe = peval(tree, options.peval_budget, options.cell_bits);
+		peval_write(pe, stdout);
+		if (options.stats) peval_print(pe, stderr);
+	}
+
+	// Marquage des boucles dans les bornes et taille de bande nécessaire.
+	b = bounds(pe.rest, pe.ptr);
+	if (options.stats) bounds_print(b, stderr);
+
+	// Blocs de base du reste, abaissés en programme linéaire par la VM.
+	blocks = block_program(pe.rest, peval_is_empty(pe), &bs);
+	if (options.stats) block_print(bs, stderr);
+
+	if (options.sparse) {
+		sparse = sparse_init(options.cell_bits / 8);
+		sparsep = &sparse;
+	} else {
+		tape = tape_init(bounds_tape_size(b, pe.cells, DATA_STACK_SIZE),
+						 options.cell_bits / 8);
+	}
+	vm_preload(pe, tape, sparsep);
+
+	vm_dispatch(pe, blocks, tape, sparsep);
+	block_free(&blocks);
+	peval_free(&pe);
+
+	if (sparsep != NULL) {
+		if (options.stats) sparse_print(sparse, stderr);
+		sparse_free(&sparse);
+	} else {
+		if (options.stats) tape_print(stderr);
+		tape_free();
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Retourne le nom du mode de distribution des instructions avec lequel
+ * la machine virtuelle a été compilée.
+ * 
+ * @return char* Le nom du mode de distribution.
+ * 
+ * @see VM_THREADED_DISPATCH
+ */
+char *vm_dispatch_mode() {
+	return VM_THREADED_DISPATCH ? "direct threading (goto calculé)"
+								: "switch (portable)";
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Imprime la configuration de compilation de la machine virtuelle sur
+ * la sortie donnée.
+ * 
+ * @param out La sortie sur laquelle imprimer la configuration.
+ */
+void vm_info(FILE *out) {
+	fprintf(out, "- Distribution des instructions : %s\n", vm_dispatch_mode());
+	fprintf(out, "- Recherche de case nulle       : %s\n", scan_isa());
+	fprintf(out, "- Ajout de vecteurs de cases    : %s\n", simd_isa());
+	fprintf(out, "- Compilation à la volée (JIT)  : %s\n",
+			JIT_AVAILABLE ? "x86-64" : "indisponible");
+	fprintf(out, "- Largeurs de case              : 8, 16, 32 bits"
+			" (défaut : %d)\n", CELL_DEFAULT_BITS);
+	fprintf(out, "- Bande creuse (-p)             : pages de %ld cases\n",
+			(long)SPARSE_PAGE_CELLS);
 }
 
 /* -------------------------------------------------------------------------- */
\ No newline at end of file
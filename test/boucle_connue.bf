@@ -0,0 +1,5 @@
+Regression du repliement des boucles de compteur connu
+la case visee est inconnue avant la boucle et fixee par elle
+affiche l octet 1 a tous les niveaux d optimisation
+
++[>]>+++<++[>[-]+<-]>.
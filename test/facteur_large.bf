@@ -0,0 +1,6 @@
+Regression du repliement des boucles affines
+en 16 ou 32 bits le facteur de la case 2 vaudrait l inverse de 3
+la boucle est gardee et la decompilation reste courte
+lit un octet x et affiche 2x sur 3 modulo 2 puissance n
+
+,[--->>++><<<]>>.